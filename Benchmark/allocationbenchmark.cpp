@@ -0,0 +1,249 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../propertyarena.hpp"
+#include "../propertydefaults.hpp"
+
+static std::size_t allocations = 0;
+
+void* operator new(std::size_t size){
+	++allocations;
+	if(void* ptr = std::malloc(size)){
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept{std::free(ptr);}
+void operator delete(void* ptr, std::size_t) noexcept{std::free(ptr);}
+
+/**
+ * Object with 50 properties, 45 plain members, 3 strings
+ *  and 2 custom read/write functors capturing more than std::function small buffer.
+ **/
+class Wide{
+	public:
+	template<class PropertyT>
+	bool presentProperties(const typename PropertyT::Visitor& visitor){
+		using any_type = typename PropertyT::any_type;
+		using interface = typename PropertyT::interface;
+		Wide* self = this;
+		float* first = &f0;
+		float* last = &f44;
+		std::string* label = &name;
+		auto readSum = [self, first, last, label](any_type& output){
+			self->sum = *first + *last + label->size();
+			output = interface::make_any(self->sum);
+		};
+		auto writeSum = [self, first, last, label](any_type& input){
+			self->sum = interface::template cast_any<float>(input) + (*first - *last) * 0 + label->size() * 0;
+		};
+		auto readScale = [self, first, last, label](any_type& output){
+			self->scale = *last - *first + label->size() * 0;
+			output = interface::make_any(self->scale);
+		};
+		auto writeScale = [self, first, last, label](any_type& input){
+			self->scale = interface::template cast_any<float>(input) + (*first - *last) * 0 + label->size() * 0;
+		};
+
+		return PropertyT::Visitor::visit(visitor, {
+			PropertyT("f0", f0),
+			PropertyT("f1", f1),
+			PropertyT("f2", f2),
+			PropertyT("f3", f3),
+			PropertyT("f4", f4),
+			PropertyT("f5", f5),
+			PropertyT("f6", f6),
+			PropertyT("f7", f7),
+			PropertyT("f8", f8),
+			PropertyT("f9", f9),
+			PropertyT("f10", f10),
+			PropertyT("f11", f11),
+			PropertyT("f12", f12),
+			PropertyT("f13", f13),
+			PropertyT("f14", f14),
+			PropertyT("f15", f15),
+			PropertyT("f16", f16),
+			PropertyT("f17", f17),
+			PropertyT("f18", f18),
+			PropertyT("f19", f19),
+			PropertyT("f20", f20),
+			PropertyT("f21", f21),
+			PropertyT("f22", f22),
+			PropertyT("f23", f23),
+			PropertyT("f24", f24),
+			PropertyT("f25", f25),
+			PropertyT("f26", f26),
+			PropertyT("f27", f27),
+			PropertyT("f28", f28),
+			PropertyT("f29", f29),
+			PropertyT("f30", f30),
+			PropertyT("f31", f31),
+			PropertyT("f32", f32),
+			PropertyT("f33", f33),
+			PropertyT("f34", f34),
+			PropertyT("f35", f35),
+			PropertyT("f36", f36),
+			PropertyT("f37", f37),
+			PropertyT("f38", f38),
+			PropertyT("f39", f39),
+			PropertyT("f40", f40),
+			PropertyT("f41", f41),
+			PropertyT("f42", f42),
+			PropertyT("f43", f43),
+			PropertyT("f44", f44),
+			PropertyT("name", name),
+			PropertyT("group", group),
+			PropertyT("tag", tag),
+			PropertyT("Sum", readSum, writeSum),
+			PropertyT("Scale", readScale, writeScale),
+		});
+	}
+
+	private:
+	float f0 = 0;
+	float f1 = 1;
+	float f2 = 2;
+	float f3 = 3;
+	float f4 = 4;
+	float f5 = 5;
+	float f6 = 6;
+	float f7 = 7;
+	float f8 = 8;
+	float f9 = 9;
+	float f10 = 10;
+	float f11 = 11;
+	float f12 = 12;
+	float f13 = 13;
+	float f14 = 14;
+	float f15 = 15;
+	float f16 = 16;
+	float f17 = 17;
+	float f18 = 18;
+	float f19 = 19;
+	float f20 = 20;
+	float f21 = 21;
+	float f22 = 22;
+	float f23 = 23;
+	float f24 = 24;
+	float f25 = 25;
+	float f26 = 26;
+	float f27 = 27;
+	float f28 = 28;
+	float f29 = 29;
+	float f30 = 30;
+	float f31 = 31;
+	float f32 = 32;
+	float f33 = 33;
+	float f34 = 34;
+	float f35 = 35;
+	float f36 = 36;
+	float f37 = 37;
+	float f38 = 38;
+	float f39 = 39;
+	float f40 = 40;
+	float f41 = 41;
+	float f42 = 42;
+	float f43 = 43;
+	float f44 = 44;
+	std::string name = "wide object with long enough name";
+	std::string group = "benchmark";
+	std::string tag = "allocation";
+	float sum = 0;
+	float scale = 0;
+};
+
+template<class PropertyT>
+/**
+ * Visits object iterations times, reading every readable property.
+ * 
+ * @return allocations done per visit.
+ **/
+double AllocationsPerVisit(Wide& object, std::size_t iterations, double& nsPerVisit){
+	std::size_t readCount = 0;
+	auto readAll = [&readCount](const PropertyT& property){
+		typename PropertyT::any_type value;
+		if(property.isReadable()){
+			property.read(value);
+			++readCount;
+		}
+		return true;
+	};
+	typename PropertyT::Visitor visitor(readAll);
+
+	std::size_t before = allocations;
+	auto start = std::chrono::steady_clock::now();
+	for(std::size_t i = 0; i < iterations; ++i){
+		object.presentProperties<PropertyT>(visitor);
+	}
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	std::size_t after = allocations;
+
+	nsPerVisit = elapsed.count() / iterations;
+	return double(after - before) / iterations;
+}
+
+/**
+ * Reloads std::string members from new values iterations times, after one warm up reload.
+ * 
+ * @param arena when not nullptr, values are made in arena, otherwise in temporary std::string.
+ * @return allocations done per reload of all members.
+ **/
+double AllocationsPerReload(std::vector<nap::Property>& properties, nap::VisitArena* arena, std::size_t iterations){
+	const std::string_view text = "configuration value longer than small string buffer";
+	auto reload = [&properties, arena, text](){
+		for(const nap::Property& property : properties){
+			if(arena != nullptr){
+				nap::Property::any_type value = arena->makeStringAny<nap::Property>(text);
+				property.write(value);
+			}
+			else{
+				std::string temporary(text);
+				nap::Property::any_type value = nap::Property::interface::make_any<std::string&>(temporary);
+				property.write(value);
+			}
+		}
+		if(arena != nullptr){
+			arena->release();
+		}
+	};
+	reload();
+
+	std::size_t before = allocations;
+	for(std::size_t i = 0; i < iterations; ++i){
+		reload();
+	}
+	std::size_t after = allocations;
+	return double(after - before) / iterations;
+}
+
+int main(){
+	constexpr std::size_t iterations = 100000;
+	Wide object;
+	double nsFunction = 0;
+	double nsFunctionRef = 0;
+
+	double function = AllocationsPerVisit<nap::Property>(object, iterations, nsFunction);
+	double functionRef = AllocationsPerVisit<nap::PropertyRef>(object, iterations, nsFunctionRef);
+
+	std::cout<<"std::function storage : "<<function<<" allocations/visit, "<<nsFunction<<" ns/visit\n";
+	std::cout<<"FunctionRef storage   : "<<functionRef<<" allocations/visit, "<<nsFunctionRef<<" ns/visit\n";
+
+	// reloading configuration into existing std::string members
+	std::vector<std::string> members(100);
+	std::vector<nap::Property> properties;
+	for(std::string& member : members){
+		properties.emplace_back("value", member);
+	}
+	nap::VisitArena arena;
+	double heapStrings = AllocationsPerReload(properties, nullptr, 1000);
+	double arenaStrings = AllocationsPerReload(properties, &arena, 1000);
+
+	std::cout<<"heap strings          : "<<heapStrings<<" allocations/reload of "<<members.size()<<" members\n";
+	std::cout<<"arena strings         : "<<arenaStrings<<" allocations/reload of "<<members.size()<<" members\n";
+
+	return (functionRef == 0 && arenaStrings == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
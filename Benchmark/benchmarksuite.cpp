@@ -0,0 +1,578 @@
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmarkutils.hpp"
+#include "../propertyarena.hpp"
+#include "../propertybatch.hpp"
+#include "../propertycolumn.hpp"
+#include "../propertyconstraint.hpp"
+#include "../propertycontainer.hpp"
+#include "../propertydiff.hpp"
+#include "../propertytransaction.hpp"
+#include "../propertytypedvisitor.hpp"
+
+using Range = std::pair<long long, long long>;
+
+/**
+ * Same shape as SimpleClass of Example/complexusage.cpp.
+ **/
+class SimpleClass{
+	public:
+	template<class PropertyT, class Visitor>
+	bool presentProperties(const Visitor& visitor){
+		using any_type = typename PropertyT::any_type;
+		using interface = typename PropertyT::interface;
+		auto readLimitedRange = [this](any_type& output){
+			output = interface::template make_any<const Range&>(limitedRange);
+		};
+		auto writeLimitedRange = [this](any_type& input){
+			const Range& newRange = interface::template cast_any<const Range&>(input);
+			setLimitedRange(newRange.first, newRange.second);
+		};
+		return PropertyT::Visitor::visit(visitor, {
+			PropertyT("Primitive types"),
+			PropertyT("a", a),
+			PropertyT("b", b),
+			PropertyT("c", c),
+			PropertyT("d", d),
+			PropertyT("Complex types"),
+			PropertyT("Range", range),
+			PropertyT("Limited Range", readLimitedRange, writeLimitedRange),
+			PropertyT("Class Name", className),
+		});
+	}
+
+	template<class PropertyT>
+	std::vector<PropertyT> propertyArray(){
+		return {
+			PropertyT("Primitive types"),
+			PropertyT("a", a),
+			PropertyT("b", b),
+			PropertyT("c", c),
+			PropertyT("d", d),
+			PropertyT("Complex types"),
+			PropertyT("Range", range),
+			PropertyT("Class Name", className),
+		};
+	}
+
+	void setLimitedRange(long long start, long long end){
+		if(start < -1500) start = -1500;
+		if(end  > 1500) end = 1500;
+		limitedRange.first = start;
+		limitedRange.second = end;
+	}
+
+	char a = 'a';
+	short b = 0x1234;
+	int c = -1;
+	float d = 3.14f;
+	Range range {-10, +10};
+	Range limitedRange {-10, +10};
+	std::string className = "SimpleClass";
+};
+
+/**
+ * Point of README example, presenting its members both via schema and property list.
+ **/
+class Point{
+	public:
+	static constexpr auto propertySchema(){
+		return nap::Schema(nap::Field("x", &Point::x), nap::Field("y", &Point::y));
+	}
+	template<class PropertyT>
+	bool presentProperties(const typename PropertyT::Visitor& visitor){
+		return PropertyT::Visitor::visit(visitor, {
+			PropertyT("x", x),
+			PropertyT("y", y)
+		});
+	}
+
+	float x = 1.0f;
+	float y = 2.0f;
+};
+
+static volatile std::size_t sink = 0;
+
+template<class PropertyT>
+std::size_t IsAnyChain(const typename PropertyT::any_type& value){
+	using prop = typename PropertyT::interface;
+	if(prop::template is_any<char>(value)) return 1;
+	else if(prop::template is_any<short>(value)) return 2;
+	else if(prop::template is_any<int>(value)) return 3;
+	else if(prop::template is_any<float>(value)) return 4;
+	else if(prop::template is_any<Range>(value)) return 5;
+	else if(prop::template is_any<std::string>(value)) return 6;
+	return 0;
+}
+
+template<class PropertyT>
+void RunPropertyBenchmarks(const std::string& prefix, std::vector<BenchmarkResult>& results){
+	using interface = typename PropertyT::interface;
+	SimpleClass object;
+
+	// custom functors are named, so properties with FunctionRef storage do not refference destroyed temporaries
+	auto readRange = [&object](typename PropertyT::any_type& output){output = interface::make_any(object.limitedRange);};
+	auto writeRange = [&object](typename PropertyT::any_type& input){object.limitedRange = interface::template cast_any<Range>(input);};
+	results.push_back(Measure(prefix + "construct", 3, [&object, &readRange, &writeRange](){
+		PropertyT properties[] = {
+			PropertyT("c", object.c),
+			PropertyT("Class Name", object.className),
+			PropertyT("Limited Range", readRange, writeRange),
+		};
+		sink = sink + properties[0].isReadable();
+	}));
+
+	const PropertyT intProperty("c", object.c);
+	const PropertyT stringProperty("Class Name", object.className);
+	results.push_back(Measure(prefix + "read_int", 1, [&intProperty](){
+		typename PropertyT::any_type value;
+		intProperty.read(value);
+		sink = sink + interface::template cast_any<int>(value);
+	}));
+	results.push_back(Measure(prefix + "read_string", 1, [&stringProperty](){
+		typename PropertyT::any_type value;
+		stringProperty.read(value);
+		sink = sink + interface::template cast_any<std::string>(value).size();
+	}));
+
+	int newInt = 7;
+	const std::string newString = "Changed SimpleClass";
+	results.push_back(Measure(prefix + "write_int_move", 1, [&intProperty, &newInt](){
+		typename PropertyT::any_type value = interface::template make_any<int&>(newInt);
+		intProperty.write(value);
+	}));
+	results.push_back(Measure(prefix + "write_string_copy", 1, [&stringProperty, &newString](){
+		typename PropertyT::any_type value = interface::make_any(newString);
+		stringProperty.write(value);
+	}));
+
+	auto readAll = [](const PropertyT& property){
+		if(property.isReadable()){
+			typename PropertyT::any_type value;
+			property.read(value);
+			sink = sink + IsAnyChain<PropertyT>(value);
+		}
+		return true;
+	};
+	typename PropertyT::Visitor visitor(readAll);
+	results.push_back(Measure(prefix + "visit_initializer_list", 1, [&object, &visitor](){
+		object.presentProperties<PropertyT>(visitor);
+	}));
+	std::vector<PropertyT> properties = object.propertyArray<PropertyT>();
+	results.push_back(Measure(prefix + "visit_array", 1, [&properties, &visitor](){
+		PropertyT::Visitor::visit(visitor, properties);
+	}));
+}
+
+void RunDispatchBenchmarks(std::vector<BenchmarkResult>& results){
+	using nap::Property;
+	SimpleClass object;
+	std::vector<Property> properties = object.propertyArray<Property>();
+
+	std::vector<Property::any_type> values;
+	for(const Property& property : properties){
+		if(property.isReadable()){
+			values.emplace_back();
+			property.read(values.back());
+		}
+	}
+
+	results.push_back(Measure("dispatch.is_any_chain", values.size(), [&values](){
+		for(const Property::any_type& value : values){
+			sink = sink + IsAnyChain<Property>(value);
+		}
+	}));
+
+	// same work as typed visitor, read of each property followed by is_any chain
+	results.push_back(Measure("dispatch.read_is_any_chain", properties.size(), [&properties](){
+		for(const Property& property : properties){
+			if(property.isReadable()){
+				Property::any_type value;
+				property.read(value);
+				sink = sink + IsAnyChain<Property>(value);
+			}
+		}
+	}));
+
+	results.push_back(Measure("dispatch.type_metadata", properties.size(), [&properties](){
+		for(const Property& property : properties){
+			const nap::TypeInfo* type = property.type();
+			if(type != nullptr && type->triviallyCopyable){
+				sink = sink + type->size;
+			}
+		}
+	}));
+
+	auto typed = nap::MakeTypedVisitor<Property, char, short, int, float, Range, std::string>(
+		[](const Property&, const auto& value){
+			sink = sink + sizeof(value);
+			return true;
+		}
+	);
+	results.push_back(Measure("dispatch.typed_visitor", properties.size(), [&properties, &typed](){
+		for(const Property& property : properties){
+			typed(property);
+		}
+	}));
+
+	// same properties with many more listed types, cost of lookup should not change
+	auto typedWide = nap::MakeTypedVisitor<Property,
+		bool, unsigned char, unsigned short, unsigned, long, unsigned long, long long, unsigned long long,
+		double, long double, std::vector<int>, std::vector<float>, std::vector<double>, std::vector<std::string>,
+		char, short, int, float, Range, std::string>(
+		[](const Property&, const auto& value){
+			sink = sink + sizeof(value);
+			return true;
+		}
+	);
+	results.push_back(Measure("dispatch.typed_visitor_20_types", properties.size(), [&properties, &typedWide](){
+		for(const Property& property : properties){
+			typedWide(property);
+		}
+	}));
+}
+
+/**
+ * Same visitor body through type erased Visitor and as callable invoked directly by specialized loop.
+ **/
+void RunVisitorBenchmarks(std::vector<BenchmarkResult>& results){
+	using nap::Property;
+	SimpleClass object;
+	Point point;
+	auto readAll = [](const Property& property){
+		if(property.isReadable()){
+			Property::any_type value;
+			property.read(value);
+			sink = sink + IsAnyChain<Property>(value);
+		}
+		return true;
+	};
+
+	Property::Visitor erased(readAll);
+	results.push_back(Measure("visitor.simple_class.std_function", 1, [&object, &erased](){
+		object.presentProperties<Property>(erased);
+	}));
+	results.push_back(Measure("visitor.simple_class.inlined", 1, [&object, &readAll](){
+		object.presentProperties<Property>(readAll);
+	}));
+	results.push_back(Measure("visitor.schema.std_function", 1, [&point, &erased](){
+		nap::VisitProperties<Property>(erased, point);
+	}));
+	results.push_back(Measure("visitor.schema.inlined", 1, [&point, &readAll](){
+		nap::VisitProperties<Property>(readAll, point);
+	}));
+	// statically typed fields, read and type dispatch are resolved at compile time
+	results.push_back(Measure("visitor.schema.fields", 1, [&point](){
+		nap::VisitFields(point, [](std::string_view, const auto& member){
+			sink = sink + sizeof(member);
+			return true;
+		});
+	}));
+}
+
+template<class PropertyT>
+void RunBatchBenchmarks(const std::string& prefix, std::vector<BenchmarkResult>& results){
+	SimpleClass source;
+	SimpleClass target;
+	std::vector<PropertyT> sourceProperties = source.propertyArray<PropertyT>();
+	std::vector<PropertyT> targetProperties = target.propertyArray<PropertyT>();
+
+	results.push_back(Measure(prefix + "copy_per_property", 1, [&sourceProperties, &targetProperties](){
+		for(std::size_t i = 0; i < sourceProperties.size(); ++i){
+			if(sourceProperties[i].isReadable() && targetProperties[i].isWritable()){
+				typename PropertyT::any_type value;
+				sourceProperties[i].read(value);
+				targetProperties[i].write(value);
+			}
+		}
+	}));
+
+	// values are copied into buffer and out of it, so this is two copies against one direct transfer
+	nap::PropertyBuffer<PropertyT> buffer(sourceProperties.size());
+	results.push_back(Measure(prefix + "copy_batch", 1, [&buffer, &sourceProperties, &targetProperties](){
+		buffer.readAll(sourceProperties);
+		buffer.writeAll(targetProperties);
+	}));
+
+	// export of values into typed storage, type of each value looked up per property
+	struct TypedValues{
+		std::vector<char> chars;
+		std::vector<short> shorts;
+		std::vector<int> ints;
+		std::vector<float> floats;
+		std::vector<Range> ranges;
+		std::vector<std::string> strings;
+	} typed;
+	results.push_back(Measure(prefix + "export_per_property", 1, [&typed, &sourceProperties](){
+		using prop = typename PropertyT::interface;
+		typed.chars.clear(); typed.shorts.clear(); typed.ints.clear(); typed.floats.clear(); typed.ranges.clear(); typed.strings.clear();
+		for(const PropertyT& property : sourceProperties){
+			if(!property.isReadable()){
+				continue;
+			}
+			typename PropertyT::any_type value;
+			property.read(value);
+			switch(IsAnyChain<PropertyT>(value)){
+				case 1: typed.chars.push_back(prop::template cast_any<char>(value)); break;
+				case 2: typed.shorts.push_back(prop::template cast_any<short>(value)); break;
+				case 3: typed.ints.push_back(prop::template cast_any<int>(value)); break;
+				case 4: typed.floats.push_back(prop::template cast_any<float>(value)); break;
+				case 5: typed.ranges.push_back(prop::template cast_any<Range>(value)); break;
+				case 6: typed.strings.push_back(prop::template cast_any<std::string>(value)); break;
+			}
+		}
+		sink = sink + typed.strings.size();
+	}));
+	// same export into typed columns of buffer, layout is kept from previous batch
+	results.push_back(Measure(prefix + "export_batch", 1, [&buffer, &sourceProperties](){
+		sink = sink + buffer.readAll(sourceProperties);
+	}));
+
+	// snapshot of object and restore of its values
+	results.push_back(Measure(prefix + "snapshot_restore", 1, [&buffer, &sourceProperties](){
+		buffer.readAll(sourceProperties);
+		buffer.writeAll(sourceProperties);
+	}));
+}
+
+void RunColumnBenchmarks(std::vector<BenchmarkResult>& results){
+	using nap::Property;
+	std::vector<Point> points(4096);
+	for(std::size_t i = 0; i < points.size(); ++i){
+		points[i].y = static_cast<float>(i);
+	}
+	std::vector<float> column(points.size());
+	auto present = [](Point& point, const Property::Visitor& visitor){
+		point.presentProperties<Property>(visitor);
+	};
+
+	results.push_back(Measure("column.visit_per_object", points.size(), [&points, &column](){
+		std::size_t index = 0;
+		auto readY = [&column, &index](const Property& property){
+			if(property.name() == "y"){
+				Property::any_type value;
+				property.read(value);
+				column[index++] = Property::interface::cast_any<float>(value);
+			}
+			return true;
+		};
+		Property::Visitor visitor(readY);
+		for(Point& point : points){
+			point.presentProperties<Property>(visitor);
+		}
+	}));
+	results.push_back(Measure("column.property_offset", points.size(), [&points, &column, &present](){
+		nap::ExtractPropertyColumn<Property>(points, "y", present, column);
+	}));
+	results.push_back(Measure("column.schema", points.size(), [&points, &column](){
+		nap::ExtractColumn(points, "y", column);
+	}));
+	sink = sink + static_cast<std::size_t>(column.back());
+}
+
+void RunArenaBenchmarks(std::vector<BenchmarkResult>& results){
+	using nap::Property;
+	constexpr std::size_t strings = 1000;
+	const std::string text = "configuration value longer than small string buffer";
+	// reloading configuration, new values written into existing std::string members
+	std::vector<std::string> targets(strings);
+	std::vector<Property> properties;
+	for(std::string& target : targets){
+		properties.emplace_back("value", target);
+	}
+
+	results.push_back(Measure("temporaries.heap_strings", strings, [&text, &properties](){
+		for(const Property& property : properties){
+			std::string temporary = text;
+			Property::any_type value = Property::interface::make_any<std::string&>(temporary);
+			property.write(value);
+		}
+	}));
+	nap::VisitArena arena(64 * 1024);
+	results.push_back(Measure("temporaries.arena_strings", strings, [&text, &properties, &arena](){
+		for(const Property& property : properties){
+			Property::any_type value = arena.makeStringAny<Property>(text);
+			property.write(value);
+		}
+		arena.release();
+	}));
+	sink = sink + targets.back().size();
+}
+
+void RunContainerBenchmarks(std::vector<BenchmarkResult>& results){
+	using nap::Property;
+	using Containers = nap::ContainerTable<Property, std::vector<float>>;
+	std::vector<float> mesh(1000000, 1.0f);
+	std::vector<float> output(mesh.size());
+	const Property property("vertices", mesh);
+
+	results.push_back(Measure("container.element_read", mesh.size(), [&property, &output](){
+		nap::ContainerRef<Property> container = Containers::Find(property);
+		container.forEach(0, container.size(), [&output](std::size_t index, Property::any_type& value){
+			output[index] = Property::interface::cast_any<float>(value);
+			return true;
+		});
+	}));
+	results.push_back(Measure("container.bulk_read", mesh.size(), [&property, &output](){
+		nap::ContainerRef<Property> container = Containers::Find(property);
+		container.readBytes(0, container.size(), output.data());
+	}));
+	sink = sink + static_cast<std::size_t>(output.back());
+}
+
+void RunDiffBenchmarks(std::vector<BenchmarkResult>& results){
+	using nap::Property;
+	std::vector<Point> saved(4096);
+	std::vector<Point> live(saved.size());
+	for(std::size_t i = 0; i < live.size(); i += 16){
+		live[i].y = static_cast<float>(i);
+	}
+	char patch[64];
+
+	results.push_back(Measure("diff.property", live.size(), [&saved, &live, &patch](){
+		nap::PropertyBuffer<Property> baseline(2);
+		for(std::size_t i = 0; i < live.size(); ++i){
+			auto reader = baseline.reader();
+			saved[i].presentProperties<Property>(Property::Visitor::Reference(reader));
+			nap::BinaryDiffWriter<Property> writer(baseline, patch, sizeof(patch));
+			live[i].presentProperties<Property>(Property::Visitor::Reference(writer));
+			sink = sink + writer.changed();
+		}
+	}));
+	results.push_back(Measure("diff.schema", live.size(), [&saved, &live, &patch](){
+		for(std::size_t i = 0; i < live.size(); ++i){
+			nap::FieldMask<Point> mask;
+			if(nap::DiffFields(live[i], saved[i], mask)){
+				sink = sink + nap::WriteFieldPatch<Property>(live[i], mask, patch, sizeof(patch));
+			}
+		}
+	}));
+}
+
+/**
+ * Configuration record with declarative constraints.
+ **/
+struct Setting{
+	static constexpr auto propertySchema(){
+		return nap::Schema(
+			nap::Field("port", &Setting::port, nap::constraint::Range(1, 65535)),
+			nap::Field("ratio", &Setting::ratio, nap::constraint::Range(0.0f, 1.0f)),
+			nap::Field("retries", &Setting::retries, nap::constraint::Range(0, 10))
+		);
+	}
+
+	int port = 8080;
+	float ratio = 0.5f;
+	int retries = 3;
+};
+
+void RunValidationBenchmarks(std::vector<BenchmarkResult>& results){
+	std::vector<Setting> settings(4096);
+	settings[100].ratio = 1.5f;
+	std::vector<nap::Violation> violations;
+
+	results.push_back(Measure("validate.per_object", settings.size(), [&settings](){
+		for(const Setting& setting : settings){
+			sink = sink + nap::Validate(setting);
+		}
+	}));
+	results.push_back(Measure("validate.batch", settings.size(), [&settings, &violations](){
+		violations.clear();
+		sink = sink + nap::ValidateObjects(settings, violations);
+	}));
+}
+
+/**
+ * Record with many fields, of which single one is written per update.
+ **/
+struct Profile{
+	static constexpr auto propertySchema(){
+		return nap::Schema(
+			nap::Field("id", &Profile::id),
+			nap::Field("level", &Profile::level),
+			nap::Field("score", &Profile::score),
+			nap::Field("ratio", &Profile::ratio),
+			nap::Field("name", &Profile::name),
+			nap::Field("title", &Profile::title),
+			nap::Field("description", &Profile::description)
+		);
+	}
+
+	int id = 1;
+	int level = 2;
+	double score = 3;
+	float ratio = 0.5f;
+	std::string name = "profile name which does not fit small string";
+	std::string title = "profile title which does not fit small string";
+	std::string description = "profile description which does not fit small string";
+};
+
+void RunTransactionBenchmarks(std::vector<BenchmarkResult>& results){
+	using nap::Property;
+	using prop = Property::interface;
+	Profile profile;
+	nap::PropertyTransaction<Property> transaction;
+	int level = 10;
+
+	// failed update of single field, restored from a copy of the whole object
+	results.push_back(Measure("transaction.snapshot", 1, [&profile, &level](){
+		const Profile saved = profile;
+		nap::VisitProperty<Property>([&level](const Property& property){
+			Property::any_type value = prop::make_any(level);
+			property.write(value);
+			return true;
+		}, profile, "level");
+		profile = saved;
+		sink = sink + profile.level;
+	}));
+	// failed update of single field, restored from recorded previous value
+	results.push_back(Measure("transaction.record", 1, [&profile, &transaction, &level](){
+		transaction.begin();
+		nap::VisitProperty<Property>([&transaction, &level](const Property& property){
+			Property::any_type value = prop::make_any(level);
+			return transaction.write(property, value);
+		}, profile, "level");
+		transaction.rollback();
+		sink = sink + profile.level;
+	}));
+}
+
+void RunWriteFallbackBenchmarks(std::vector<BenchmarkResult>& results){
+	SimpleClass object;
+	const std::string newString = "Changed SimpleClass";
+
+	const ThrowingProperty throwingProperty("Class Name", object.className);
+	results.push_back(Measure("write_fallback.exception", 1, [&throwingProperty, &newString](){
+		ThrowingProperty::any_type value = ThrowingProperty::interface::make_any(newString);
+		throwingProperty.write(value);
+	}));
+	const nap::Property property("Class Name", object.className);
+	results.push_back(Measure("write_fallback.type_check", 1, [&property, &newString](){
+		nap::Property::any_type value = nap::Property::interface::make_any(newString);
+		property.write(value);
+	}));
+}
+
+int main(int argc, char** argv){
+	bool csv = (argc > 1 && std::strcmp(argv[1], "--csv") == 0);
+
+	std::vector<BenchmarkResult> results;
+	RunPropertyBenchmarks<nap::Property>("property.", results);
+	RunPropertyBenchmarks<nap::PropertyRef>("property_ref.", results);
+	RunDispatchBenchmarks(results);
+	RunVisitorBenchmarks(results);
+	RunBatchBenchmarks<nap::Property>("batch.property.", results);
+	RunBatchBenchmarks<nap::PropertyRef>("batch.property_ref.", results);
+	RunColumnBenchmarks(results);
+	RunArenaBenchmarks(results);
+	RunContainerBenchmarks(results);
+	RunDiffBenchmarks(results);
+	RunValidationBenchmarks(results);
+	RunTransactionBenchmarks(results);
+	RunWriteFallbackBenchmarks(results);
+
+	PrintResults(results, csv);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../propertydefaults.hpp"
+
+/**
+ * Interface identical to DefaultInterface, except for write which uses
+ *  the former exception based move/copy fallback, kept here as baseline.
+ **/
+struct ThrowingInterface : nap::detail::DefaultInterface{
+	template<typename T>
+	static void write(T& value, any_type& any){
+		try{
+			value = std::move(cast_any<T&>(any));
+			return;
+		}
+		catch(const std::bad_any_cast&){/* write by move failed */}
+		// try write by copy
+		value = cast_any<const T&>(any);
+	}
+};
+
+using ThrowingProperty = nap::PropertyTemplate<ThrowingInterface>;
+
+/**
+ * Result of single measured operation.
+ **/
+struct BenchmarkResult{
+	std::string name;
+	std::size_t iterations;
+	double nsPerOperation;
+};
+
+template<class Callable>
+/**
+ * Runs callable in growing batches until batch takes at least minimal time,
+ *  then reports time per operation of the last batch.
+ * 
+ * @param operationsPerCall number of measured operations done by single call of callable.
+ **/
+BenchmarkResult Measure(const std::string& name, std::size_t operationsPerCall, Callable callable){
+	using clock = std::chrono::steady_clock;
+	constexpr std::chrono::milliseconds minimalTime(100);
+
+	std::size_t iterations = 1;
+	for(;;){
+		auto start = clock::now();
+		for(std::size_t i = 0; i < iterations; ++i){
+			callable();
+		}
+		auto elapsed = clock::now() - start;
+		if(elapsed >= minimalTime || iterations >= (std::size_t(1) << 40)){
+			std::chrono::duration<double, std::nano> ns = elapsed;
+			return BenchmarkResult{name, iterations * operationsPerCall, ns.count() / (iterations * operationsPerCall)};
+		}
+		iterations *= 2;
+	}
+}
+
+/**
+ * Prints results as json array, or as csv with header when csv is true.
+ **/
+inline void PrintResults(const std::vector<BenchmarkResult>& results, bool csv){
+	if(csv){
+		std::printf("name,iterations,ns_per_op,ops_per_sec\n");
+		for(const BenchmarkResult& result : results){
+			std::printf("%s,%zu,%.3f,%.0f\n", result.name.c_str(), result.iterations, result.nsPerOperation, 1e9 / result.nsPerOperation);
+		}
+		return;
+	}
+	std::printf("[\n");
+	for(std::size_t i = 0; i < results.size(); ++i){
+		const BenchmarkResult& result = results[i];
+		std::printf("  {\"name\": \"%s\", \"iterations\": %zu, \"ns_per_op\": %.3f, \"ops_per_sec\": %.0f}%s\n",
+			result.name.c_str(), result.iterations, result.nsPerOperation, 1e9 / result.nsPerOperation,
+			(i + 1 < results.size()) ? "," : "");
+	}
+	std::printf("]\n");
+}
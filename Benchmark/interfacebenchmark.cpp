@@ -0,0 +1,85 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "../propertydefaults.hpp"
+#include "../propertyvariant.hpp"
+
+using VariantProperty = nap::VariantProperty<int, float, double, std::string>;
+
+struct Record{
+	int id = 1;
+	float weight = 2;
+	double score = 3;
+	std::string name = "record";
+};
+
+template<class Callable>
+double NanosecondsPerCall(std::size_t iterations, std::size_t callsPerIteration, Callable callable){
+	auto start = std::chrono::steady_clock::now();
+	for(std::size_t i = 0; i < iterations; ++i){
+		callable();
+	}
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / (iterations * callsPerIteration);
+}
+
+template<class PropertyT>
+/**
+ * Measures read, is_any chain and write of every member of record.
+ **/
+void Run(const char* interfaceName, std::size_t iterations){
+	using interface = typename PropertyT::interface;
+	Record record;
+	Record source{4, 5, 6, "source"};
+	const PropertyT properties[] = {
+		PropertyT("id", record.id),
+		PropertyT("weight", record.weight),
+		PropertyT("score", record.score),
+		PropertyT("name", record.name),
+	};
+	const typename PropertyT::any_type sources[] = {
+		interface::make_any(source.id),
+		interface::make_any(source.weight),
+		interface::make_any(source.score),
+		interface::make_any(source.name),
+	};
+	volatile std::size_t sink = 0;
+
+	double read = NanosecondsPerCall(iterations, 4, [&properties, &sink](){
+		typename PropertyT::any_type value;
+		for(const PropertyT& property : properties){
+			property.read(value);
+			sink = sink + interface::template is_any<int>(value);
+		}
+	});
+
+	double isAny = NanosecondsPerCall(iterations, 4, [&properties, &sink](){
+		typename PropertyT::any_type value;
+		for(const PropertyT& property : properties){
+			property.read(value);
+			std::size_t match = 0;
+			if(interface::template is_any<int>(value)) match = 1;
+			else if(interface::template is_any<float>(value)) match = 2;
+			else if(interface::template is_any<double>(value)) match = 3;
+			else if(interface::template is_any<std::string>(value)) match = 4;
+			sink = sink + match;
+		}
+	});
+
+	double write = NanosecondsPerCall(iterations, 4, [&properties, &sources](){
+		for(std::size_t i = 0; i < 4; ++i){
+			typename PropertyT::any_type value = sources[i];
+			properties[i].write(value);
+		}
+	});
+
+	std::cout<<interfaceName<<": read "<<read<<" ns, read + is_any chain "<<isAny<<" ns, write "<<write<<" ns\n";
+}
+
+int main(){
+	constexpr std::size_t iterations = 2000000;
+
+	Run<nap::Property>("DefaultInterface", iterations);
+	Run<VariantProperty>("VariantInterface", iterations);
+}
@@ -0,0 +1,89 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../propertydefaults.hpp"
+#include "../propertyparallel.hpp"
+
+class Particle{
+	public:
+	bool presentProperties(const nap::PropertyRef::Visitor& visitor) const{
+		using nap::PropertyRef;
+		return PropertyRef::Visitor::visit(visitor, {
+			PropertyRef("id", id),
+			PropertyRef("x", x),
+			PropertyRef("y", y),
+			PropertyRef("mass", mass),
+		});
+	}
+
+	std::uint32_t id = 0;
+	float x = 0, y = 0, mass = 1;
+};
+
+/**
+ * Checksum of all integer and float properties of particle.
+ **/
+std::uint64_t Checksum(const Particle& particle){
+	using prop = nap::PropertyRef::interface;
+	std::uint64_t checksum = 0;
+	auto accumulate = [&checksum](const nap::PropertyRef& property){
+		nap::PropertyRef::any_type value;
+		property.read(value);
+		if(prop::is_any<std::uint32_t>(value)){
+			checksum = checksum * 31 + prop::cast_any<std::uint32_t>(value);
+		}
+		else if(prop::is_any<float>(value)){
+			checksum = checksum * 31 + static_cast<std::uint64_t>(prop::cast_any<float>(value) * 1000);
+		}
+		return true;
+	};
+	particle.presentProperties(nap::PropertyRef::Visitor(accumulate));
+	return checksum;
+}
+
+int main(){
+	constexpr std::size_t count = 2000000;
+	std::vector<Particle> particles(count);
+	for(std::size_t i = 0; i < count; ++i){
+		particles[i].id = static_cast<std::uint32_t>(i);
+		particles[i].x = i * 0.5f;
+		particles[i].y = i * 0.25f;
+	}
+
+	auto visit = [](const Particle& particle, std::uint64_t& chunkChecksum){
+		chunkChecksum ^= Checksum(particle);
+		return true;
+	};
+	auto reduce = [](std::uint64_t checksum, std::uint64_t chunkChecksum){
+		return checksum * 1000003 ^ chunkChecksum;
+	};
+
+	const std::size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	double singleThreaded = 0;
+	for(std::size_t threads = 1; threads <= maxThreads; threads *= 2){
+		nap::VisitPool pool(threads);
+		std::uint64_t checksum = 0;
+
+		auto start = std::chrono::steady_clock::now();
+		pool.visitReduce(particles.begin(), particles.end(), checksum, visit, reduce);
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+		if(threads == 1){
+			singleThreaded = elapsed.count();
+		}
+		std::cout<<threads<<" threads: "<<elapsed.count()<<" ms, speedup "<<singleThreaded / elapsed.count()
+				 <<"x, checksum "<<checksum<<'\n';
+	}
+
+	// early exit cancels remaining chunks
+	nap::VisitPool pool(maxThreads);
+	std::atomic<std::size_t> visited{0};
+	bool completed = pool.visit(particles.begin(), particles.end(), [&visited](const Particle& particle){
+		++visited;
+		return particle.id != 1000;
+	});
+	std::cout<<"early exit: completed "<<completed<<", visited "<<visited<<" of "<<count<<'\n';
+}
@@ -0,0 +1,94 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../propertydefaults.hpp"
+#include "../propertysync.hpp"
+
+struct Vec3{
+	float x = 0, y = 0, z = 0;
+};
+
+template<class Source>
+/**
+ * Object with single synchronized member, presented as property reading its snapshot.
+ **/
+class Body{
+	public:
+	bool presentProperties(const nap::PropertyRef::Visitor& visitor){
+		nap::SyncView<Source> position(m_position);
+		return nap::PropertyRef::Visitor::visit(visitor, {
+			position.template property<nap::PropertyRef>("position"),
+		});
+	}
+
+	Source& position(){return m_position;}
+
+	private:
+	Source m_position;
+};
+
+template<class Source>
+/**
+ * Visits body from reader threads while one thread keeps writing x == y == z.
+ * 
+ * @return reads per second of all readers together, torn reads are reported.
+ **/
+double ReadsPerSecond(std::size_t readers, std::size_t readsPerThread){
+	Body<Source> body;
+	std::atomic<bool> running{true};
+	std::atomic<std::size_t> torn{0};
+
+	std::thread writer([&body, &running](){
+		float value = 0;
+		while(running.load(std::memory_order_relaxed)){
+			value += 1;
+			body.position().store(Vec3{value, value, value});
+		}
+	});
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for(std::size_t i = 0; i < readers; ++i){
+		threads.emplace_back([&body, &torn, readsPerThread](){
+			auto check = [&torn](const nap::PropertyRef& property){
+				nap::PropertyRef::any_type value;
+				property.read(value);
+				const Vec3& position = nap::PropertyRef::interface::cast_any<Vec3>(value);
+				if(position.x != position.y || position.y != position.z){
+					++torn;
+				}
+				return true;
+			};
+			nap::PropertyRef::Visitor visitor(check);
+			for(std::size_t read = 0; read < readsPerThread; ++read){
+				body.presentProperties(visitor);
+			}
+		});
+	}
+	for(std::thread& thread : threads){
+		thread.join();
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	running = false;
+	writer.join();
+
+	if(torn != 0){
+		std::cout<<"torn reads: "<<torn<<'\n';
+	}
+	return (readers * readsPerThread) / elapsed.count();
+}
+
+int main(){
+	constexpr std::size_t readsPerThread = 500000;
+	const std::size_t maxReaders = std::max(1u, std::thread::hardware_concurrency() - 1);
+
+	for(std::size_t readers = 1; readers <= maxReaders; readers *= 2){
+		double seqLock = ReadsPerSecond<nap::SeqLocked<Vec3>>(readers, readsPerThread);
+		double rwLock = ReadsPerSecond<nap::RwLocked<Vec3>>(readers, readsPerThread);
+		std::cout<<readers<<" readers: seqlock "<<static_cast<long long>(seqLock)<<" reads/s, rwlock "
+				 <<static_cast<long long>(rwLock)<<" reads/s\n";
+	}
+}
@@ -0,0 +1,63 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "benchmarkutils.hpp"
+
+struct Record{
+	int id = 0;
+	float weight = 0;
+	double score = 0;
+	std::string name = "record";
+	std::string description = "mixed primitive and string members";
+};
+
+template<class PropertyT>
+/**
+ * Writes every member of record from source, through const-qualified entries (copy path).
+ **/
+void WriteRecord(Record& record, const Record& source){
+	using interface = typename PropertyT::interface;
+	typename PropertyT::Visitor visitor([&source](const PropertyT& property){
+		typename PropertyT::any_type value;
+		if(property.name() == "id") value = interface::make_any(source.id);
+		else if(property.name() == "weight") value = interface::make_any(source.weight);
+		else if(property.name() == "score") value = interface::make_any(source.score);
+		else if(property.name() == "name") value = interface::make_any(source.name);
+		else value = interface::make_any(source.description);
+		property.write(value);
+		return true;
+	});
+	PropertyT::Visitor::visit(visitor, {
+		PropertyT("id", record.id),
+		PropertyT("weight", record.weight),
+		PropertyT("score", record.score),
+		PropertyT("name", record.name),
+		PropertyT("description", record.description),
+	});
+}
+
+template<class PropertyT>
+double WritesPerSecond(std::size_t iterations){
+	Record record;
+	Record source{42, 1.5f, 2.25, "source name", "source description"};
+
+	auto start = std::chrono::steady_clock::now();
+	for(std::size_t i = 0; i < iterations; ++i){
+		WriteRecord<PropertyT>(record, source);
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	return (iterations * 5) / elapsed.count();
+}
+
+int main(){
+	constexpr std::size_t iterations = 200000;
+
+	double before = WritesPerSecond<ThrowingProperty>(iterations);
+	double after = WritesPerSecond<nap::Property>(iterations);
+
+	std::cout<<"write by copy (exception fallback): "<<static_cast<long long>(before)<<" writes/s\n";
+	std::cout<<"write by copy (type check)        : "<<static_cast<long long>(after)<<" writes/s\n";
+	std::cout<<"speedup: "<<after / before<<"x\n";
+}
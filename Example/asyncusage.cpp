@@ -0,0 +1,173 @@
+// requires C++20 coroutines, built with C++20 by CMake when compiler supports it
+#include <coroutine>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../propertyasync.hpp"
+#include "../propertybinary.hpp"
+#include "../propertydefaults.hpp"
+
+class Transform{
+	public:
+	static constexpr auto propertySchema(){
+		return nap::Schema(
+			nap::Field("name", &Transform::name),
+			nap::Field("x", &Transform::x),
+			nap::Field("y", &Transform::y),
+			nap::Field("scale", &Transform::scale)
+		);
+	}
+
+	std::string name = "Transform";
+	float x = 1.0f;
+	float y = 2.0f;
+	double scale = 0.5;
+};
+
+class Settings{
+	public:
+	void propertiesFunc(const nap::Property::Visitor& visitor){
+		using nap::Property;
+		Property::Visitor::visit(visitor, {
+			Property("Settings"),
+			Property("port", port),
+			Property("host", host),
+			Property("retries", retries),
+		});
+	}
+
+	int port = 8080;
+	std::string host = "localhost";
+	short retries = 3;
+};
+
+/**
+ * In-memory sink accepting at most budget bytes per tick, writers waiting for budget are suspended
+ *  and posted back to loop on next tick.
+ **/
+class ThrottledSink{
+	public:
+	ThrottledSink(nap::VisitLoop& loop, std::size_t budget) : m_loop(loop), m_budget(budget), m_available(budget){}
+
+	auto write(const char* data, std::size_t size){
+		struct WriteAwaiter{
+			bool await_ready(){return sink.tryWrite(data, size);}
+			void await_suspend(std::coroutine_handle<> handle){sink.m_waiting.push_back(Waiting{handle, data, size});}
+			bool await_resume(){return true;}
+
+			ThrottledSink& sink;
+			const char* data;
+			std::size_t size;
+		};
+		return WriteAwaiter{*this, data, size};
+	}
+
+	/**
+	 * Refills budget and posts writers which fit into it, in order of waiting.
+	 **/
+	void tick(){
+		m_available = m_budget;
+		std::vector<Waiting> waiting;
+		waiting.swap(m_waiting);
+		for(const Waiting& writer : waiting){
+			if(tryWrite(writer.data, writer.size)){
+				m_loop.post(writer.handle);
+			}
+			else{
+				m_waiting.push_back(writer);
+			}
+		}
+	}
+
+	const std::string& received() const{return m_received;}
+
+	private:
+	struct Waiting{
+		std::coroutine_handle<> handle;
+		const char* data;
+		std::size_t size;
+	};
+
+	bool tryWrite(const char* data, std::size_t size){
+		// chunks larger than budget are accepted at the start of tick, so they cannot wait forever
+		if(size > m_available && m_available != m_budget){
+			return false;
+		}
+		m_received.append(data, size);
+		m_available -= std::min(size, m_available);
+		return true;
+	}
+
+	nap::VisitLoop& m_loop;
+	std::size_t m_budget;
+	std::size_t m_available;
+	std::vector<Waiting> m_waiting;
+	std::string m_received;
+};
+
+/**
+ * Bytes of BinaryWriter archive after its schema hash header, which stream writer produces.
+ **/
+template<class PresentFunc>
+std::string Expected(const PresentFunc& present){
+	char buffer[256];
+	nap::BinaryWriter<nap::Property> writer(buffer, sizeof(buffer));
+	present(nap::Property::Visitor::Reference(writer));
+	writer.finish();
+	return std::string(buffer + sizeof(std::uint64_t), writer.size() - sizeof(std::uint64_t));
+}
+
+int main(){
+	using nap::Property;
+	nap::VisitLoop loop;
+
+	std::vector<Transform> transforms(3);
+	for(std::size_t i = 0; i < transforms.size(); ++i){
+		transforms[i].name = "Transform " + std::to_string(i);
+		transforms[i].x = static_cast<float>(i);
+	}
+	Settings settings;
+
+	// one sink per object, all of them are written concurrently on this thread
+	std::vector<ThrottledSink> sinks;
+	for(std::size_t i = 0; i <= transforms.size(); ++i){
+		sinks.emplace_back(loop, 8);
+	}
+	std::vector<nap::AsyncStreamWriter<Property, ThrottledSink>> writers;
+	for(ThrottledSink& sink : sinks){
+		writers.emplace_back(sink);
+	}
+
+	for(std::size_t i = 0; i < transforms.size(); ++i){
+		loop.spawn(nap::VisitFieldsAsync<Property>(transforms[i], writers[i]));
+	}
+	std::vector<Property> settingsProperties = nap::CollectProperties<Property>(
+		[&settings](const Property::Visitor& visitor){settings.propertiesFunc(visitor);}
+	);
+	std::size_t settingsTask = loop.spawn(nap::VisitAsync<Property>(settingsProperties, writers.back(), 2));
+
+	std::size_t ticks = 0;
+	while(loop.pending()){
+		loop.run();
+		for(ThrottledSink& sink : sinks){
+			sink.tick();
+		}
+		++ticks;
+	}
+
+	bool matches = true;
+	for(std::size_t i = 0; i < transforms.size(); ++i){
+		std::string expected = Expected([&transforms, i](const Property::Visitor& visitor){
+			nap::VisitProperties<Property>(visitor, transforms[i]);
+		});
+		matches = matches && (sinks[i].received() == expected) && loop.result(i);
+	}
+	std::string expectedSettings = Expected([&settings](const Property::Visitor& visitor){settings.propertiesFunc(visitor);});
+	matches = matches && (sinks.back().received() == expectedSettings) && loop.result(settingsTask);
+
+	std::cout<<"Streamed "<<sinks.size()<<" objects in "<<ticks<<" ticks of 8 bytes per sink\n";
+	std::cout<<"Matches synchronous binary writer: "<<(matches ? "yes" : "no")<<'\n';
+	return matches ? 0 : 1;
+}
@@ -1,7 +1,9 @@
 #include <iostream>
 #include <utility>
 
+#include "../propertyarena.hpp"
 #include "../propertydefaults.hpp"
+#include "../propertytypedvisitor.hpp"
 
 #define PROPERTIES(...) \
 void propertiesFunc(const nap::Property::Visitor& visitor){\
@@ -64,55 +66,46 @@ int main(){
     
     SimpleClass simpleClass;
 
-    nap::Property::Visitor readingVisitor(
+    auto readingHandlers = nap::Overloaded{
         [](const nap::Property& property){
-        using namespace nap;
-        using any_t = Property::any_type;
-		using prop = Property::interface;
-
-        if(property.isNameOnly()){
             std::cout<<"[Category] "<<property.name()<<":\n";
             return true;
-        }
-        if(!property.isReadable()){
+        },
+        [](const nap::Property& property, char value){
+            std::cout<<"\tValue["<<property.name()<<"]: "<<value<<'\n';
+            return true;
+        },
+        [](const nap::Property& property, short value){
+            std::cout<<"\tValue["<<property.name()<<"]: "<<std::hex<<"0x"<<value<<'\n';
+            return true;
+        },
+        [](const nap::Property& property, int value){
+            std::cout<<"\tValue["<<property.name()<<"]: "<<std::dec<<value<<'\n';
+            return true;
+        },
+        [](const nap::Property& property, float value){
+            std::cout<<"\tValue["<<property.name()<<"]: "<<value<<'\n';
+            return true;
+        },
+        [](const nap::Property& property, const Range& range){
+            std::cout<<"\tValue["<<property.name()<<"]: {"<< range.first<<", "<<range.second<<"}\n";
+            return true;
+        },
+        [](const nap::Property& property, const std::string& className){
+            std::cout<<"\tValue["<<property.name()<<"]: "<<className<<'\n';
             return true;
         }
-        
-        // read into value
-        any_t v;
-        property.read(v);
-        const any_t& value = v;
-
-        nap::Property::string_type propName = property.name();
-
-        if(prop::is_any<char>(value)){
-            std::cout<<"\tValue["<<propName<<"]: "<<prop::cast_any<char>(value)<<'\n';
-        }
-        else if(prop::is_any<short>(value)){
-            std::cout<<"\tValue["<<propName<<"]: "<<std::hex<<"0x"<<prop::cast_any<short>(value)<<'\n';
-        }
-        else if(prop::is_any<int>(value)){
-            std::cout<<"\tValue["<<propName<<"]: "<<std::dec <<prop::cast_any<int>(value)<<'\n';
-        }
-        else if(prop::is_any<float>(value)){
-            std::cout<<"\tValue["<<propName<<"]: "<<prop::cast_any<float>(value)<<'\n';
-        }
-        else if(prop::is_any<const Range&>(value)){
-            const Range& range = prop::cast_any<const Range&>(value);
-            std::cout<<"\tValue["<<propName<<"]: {"<< range.first<<", "<<range.second<<"}\n";
-        }
-        else if(prop::is_any<const std::string&>(value)){
-            const std::string& className = prop::cast_any<const std::string&>(value);
-            std::cout<<"\tValue["<<propName<<"]: "<<className<<'\n';
-        }
-
-        return true;
-        
-    });
+    };
+    // each property is dispatched to its handler by single type lookup
+    nap::Property::Visitor readingVisitor(
+        nap::MakeTypedVisitor<nap::Property, char, short, int, float, Range, std::string>(readingHandlers)
+    );
 
 
+    // new values live in arena until whole visit finishes
+    nap::VisitArena arena;
     nap::Property::Visitor writingVisitor(
-        [](const nap::Property& property){
+        [&arena](const nap::Property& property){
         using namespace nap;
         using any_t = Property::any_type;
 		using prop = Property::interface;
@@ -130,27 +123,28 @@ int main(){
             property.read(value);
         }
         
-        auto range = Range(-20000,30000);
+        char letter = 'A';
+        short word = 0x4321;
+        int one = +1;
 
         if(prop::is_any<char>(value)){
-            value = prop::make_any('A');
+            value = prop::make_any(letter);
         }
         else if(prop::is_any<short>(value)){
-            value = prop::make_any((short)0x4321);
+            value = prop::make_any(word);
         }
         else if(prop::is_any<int>(value)){
-            value = prop::make_any((int)+1);
+            value = prop::make_any(one);
         }
         else if(prop::is_any<float>(value)){
-            value = prop::make_any((float)3.14/2);
+            value = arena.makeAny<Property, float>((float)3.14/2);
         }
         else if(prop::is_any<const Range>(value)){
-            value = prop::make_any<Range&>(range);
+            value = arena.makeAny<Property, Range>(-20000, 30000);
         }
         else if(prop::is_any<const std::string>(value)){
             const std::string& className = prop::cast_any<const std::string&>(value);
-            auto newVal = std::string("Changed ")+className;            
-            value = prop::make_any<std::string&>(newVal);       
+            value = arena.makeAny<Property, std::string>(std::string("Changed ")+className);
             property.write(value);
             return true;
         }
@@ -167,6 +161,7 @@ int main(){
     std::cout<<"\n<------------------------------------->\n\n";
 
     simpleClass.propertiesFunc(writingVisitor);
+    arena.release();
     std::cout<<"\n<------------------------------------->\n\n";
 
     simpleClass.propertiesFunc(readingVisitor);
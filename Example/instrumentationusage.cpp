@@ -0,0 +1,65 @@
+// instrumentation hooks are compiled only when this is defined before including properties
+//  (CMake option NAP_INSTRUMENTATION defines it for all translation units)
+#ifndef NAP_INSTRUMENTATION
+#define NAP_INSTRUMENTATION
+#endif
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+#include "../propertybinary.hpp"
+#include "../propertydefaults.hpp"
+
+using Range = std::pair<long long, long long>;
+class SimpleClass{
+	public:
+	void propertiesFunc(const nap::Property::Visitor& visitor){
+		using nap::Property;
+		Property::Visitor::visit(visitor, {
+			Property("a", a),
+			Property("Range", range),
+			Property("Limited Range",
+				[this](Property::any_type& output){
+					output = Property::interface::make_any<const Range&>(limitedRange);
+				},
+				// deliberately slow setter, which should stand out in report
+				[this](Property::any_type& input){
+					const Range& newRange = Property::interface::cast_any<Range>(input);
+					std::this_thread::sleep_for(std::chrono::microseconds(50));
+					limitedRange = newRange;
+				}
+			),
+			Property("Class Name", className),
+		});
+	}
+
+	private:
+	int a = 1;
+	Range range {-10, +10};
+	Range limitedRange {-10, +10};
+	std::string className = "SimpleClass";
+};
+
+int main(){
+	SimpleClass simpleClass;
+
+	// write every property back with its own value
+	nap::Property::Visitor rewrite([](const nap::Property& property){
+		nap::Property::any_type value;
+		property.read(value);
+		property.write(value);
+		return true;
+	});
+	for(int i = 0; i < 100; ++i){
+		simpleClass.propertiesFunc(rewrite);
+	}
+
+	char buffer[256];
+	nap::BinaryWriter<nap::Property> writer(buffer, sizeof(buffer));
+	simpleClass.propertiesFunc(nap::Property::Visitor::Reference(writer));
+	writer.finish();
+
+	std::cout<<nap::instrumentation::Report();
+}
@@ -0,0 +1,140 @@
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "../propertydefaults.hpp"
+#include "../propertyjson.hpp"
+#include "../propertyschema.hpp"
+
+class Position{
+	public:
+	static constexpr auto propertySchema(){
+		return nap::Schema(
+			nap::Field("x", &Position::x),
+			nap::Field("y", &Position::y)
+		);
+	}
+
+	bool operator==(const Position& other) const{return x == other.x && y == other.y;}
+
+	float x = 0.0f;
+	float y = 0.0f;
+};
+
+class Player{
+	public:
+	static constexpr auto propertySchema(){
+		return nap::Schema(
+			nap::Field("name", &Player::name),
+			nap::Field("motto \"quoted\"", &Player::motto),
+			nap::Field("position", &Player::position),
+			nap::Field("level", &Player::level),
+			nap::Field("notes", &Player::notes)
+		);
+	}
+
+	bool operator==(const Player& other) const{
+		return name == other.name && motto == other.motto && position == other.position && level == other.level && notes == other.notes;
+	}
+
+	std::string name;
+	std::string motto;
+	Position position;
+	int level = 0;
+	std::string notes;
+};
+
+class Settings{
+	public:
+	void propertiesFunc(const nap::Property::Visitor& visitor){
+		using nap::Property;
+		Property::Visitor::visit(visitor, {
+			Property("Network"),
+			Property("port", port),
+			Property("host", host),
+			Property("Limits"),
+			Property("retries", retries),
+		});
+	}
+
+	int port = 0;
+	std::string host;
+	short retries = 0;
+};
+
+template<class Object>
+std::string Write(Object& object){
+	std::string text;
+	nap::JsonStringSink sink(text);
+	nap::JsonWriter<nap::Property, nap::JsonStringSink> writer(sink);
+	nap::VisitProperties<nap::Property>(nap::Property::Visitor::Reference(writer), object);
+	writer.finish();
+	return text;
+}
+
+template<class Object, class Input>
+bool Read(Object& object, Input& input){
+	nap::JsonReader<nap::Property> reader(input);
+	bool visited = nap::VisitProperties<nap::Property>(nap::Property::Visitor::Reference(reader), object);
+	return reader.finish() && visited;
+}
+
+int main(){
+	Player player;
+	player.name = "Line\nbreak, tab\t and \"quotes\"";
+	player.motto = "\xc3\xa9t\xc3\xa9 \\ slash";
+	player.position = Position{1.5f, -2.0f};
+	player.level = 42;
+	// longer than window of streamed input, so strings and tokens cross its boundary
+	for(int i = 0; i < 1000; ++i){
+		player.notes += "note \"" + std::to_string(i) + "\"\n";
+	}
+
+	// round trip from memory
+	std::string text = Write(player);
+	Player fromText;
+	bool matches = Read(fromText, text) && (fromText == player);
+
+	// round trip streamed from file through fixed size window
+	bool streamed = false;
+	if(std::FILE* file = std::tmpfile()){
+		std::fwrite(text.data(), 1, text.size(), file);
+		std::rewind(file);
+		nap::JsonFileSource source(file);
+		Player fromFile;
+		streamed = Read(fromFile, source) && !source.failed() && (fromFile == player);
+		std::fclose(file);
+	}
+
+	// keys in other order than visited, escaped keys and unknown keys
+	const std::string reordered =
+		"{\"notes\":\"n\",\"unknown\":{\"a\":[1,2,{\"b\":null}]},\"level\":7,"
+		"\"position\":{\"y\":4,\"x\":3},\"motto \\\"quoted\\\"\":\"m\",\"na\\u006de\":\"\\u00e9\"}";
+	Player fromReordered;
+	Player expected;
+	expected.name = "\xc3\xa9";
+	expected.motto = "m";
+	expected.position = Position{3.0f, 4.0f};
+	expected.level = 7;
+	expected.notes = "n";
+	bool reorderedMatches = Read(fromReordered, reordered) && (fromReordered == expected);
+
+	// categories of name only properties in other order, with missing key
+	const std::string categories = "{\"Limits\":{\"retries\":5},\"Network\":{\"host\":\"example.org\",\"port\":80}}";
+	Settings settings;
+	nap::JsonReader<nap::Property> settingsReader(categories);
+	settings.propertiesFunc(nap::Property::Visitor::Reference(settingsReader));
+	bool categoriesMatch = settingsReader.finish() && settings.port == 80 && settings.host == "example.org" && settings.retries == 5;
+
+	// truncated input is reported
+	Player fromTruncated;
+	std::string truncated = text.substr(0, text.size() / 2);
+	bool truncatedFails = !Read(fromTruncated, truncated);
+
+	std::cout<<"Round trip from memory: "<<(matches ? "yes" : "no")<<'\n';
+	std::cout<<"Round trip streamed from file: "<<(streamed ? "yes" : "no")<<'\n';
+	std::cout<<"Reordered and escaped keys: "<<(reorderedMatches ? "yes" : "no")<<'\n';
+	std::cout<<"Reordered categories: "<<(categoriesMatch ? "yes" : "no")<<'\n';
+	std::cout<<"Truncated input rejected: "<<(truncatedFails ? "yes" : "no")<<'\n';
+	return (matches && streamed && reorderedMatches && categoriesMatch && truncatedFails) ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+#include <iostream>
+#include <string>
+#include <type_traits>
+
+#include "../propertydefaults.hpp"
+#include "../propertypath.hpp"
+#include "../propertyschema.hpp"
+
+class Vector2{
+	public:
+	static constexpr auto propertySchema(){
+		return nap::Schema(
+			nap::Field("x", &Vector2::x),
+			nap::Field("y", &Vector2::y)
+		);
+	}
+
+	float x = 0.0f;
+	float y = 0.0f;
+};
+
+class Transform{
+	public:
+	static constexpr auto propertySchema(){
+		return nap::Schema(
+			nap::Field("name", &Transform::name),
+			nap::Field("position", &Transform::position),
+			nap::Field("scale", &Transform::scale)
+		);
+	}
+
+	std::string name = "Transform";
+	Vector2 position;
+	Vector2 scale{1.0f, 1.0f};
+};
+
+class Window{
+	public:
+	void propertiesFunc(const nap::Property::Visitor& visitor){
+		using nap::Property;
+		Property::Visitor::visit(visitor, {
+			Property("title", title),
+			Property::Nested("size", [this](const Property::Visitor& visitor){
+				return Property::Visitor::visit(visitor, {
+					Property("width", width),
+					Property("height", height)
+				});
+			}),
+			// children of other subtrees are not constructed when path does not lead through them
+			Property::Nested("theme", [this](const Property::Visitor& visitor){
+				++themeVisits;
+				return Property::Visitor::visit(visitor, {Property("dark", dark)});
+			}),
+		});
+	}
+
+	std::string title = "Main";
+	int width = 640;
+	int height = 480;
+	bool dark = false;
+	int themeVisits = 0;
+};
+
+/**
+ * Writes value into property found at path of window properties.
+ **/
+bool SetWindowInt(Window& window, std::string_view path, int value){
+	using nap::Property;
+	Property::Visitor setter([value](const Property& property){
+		if(!property.isWritable()){
+			return false;
+		}
+		Property::any_type input = Property::interface::make_any(value);
+		property.write(input);
+		return true;
+	});
+	return nap::VisitPath<Property>(setter, path, [&window](const Property::Visitor& visitor){window.propertiesFunc(visitor);});
+}
+
+int main(){
+	using nap::Property;
+
+	// property lists with nested properties
+	Window window;
+	bool hit = SetWindowInt(window, "size.height", 720) && window.height == 720 && window.width == 640;
+	bool misses = !SetWindowInt(window, "size.depth", 1) && !SetWindowInt(window, "depth", 1)
+		&& !SetWindowInt(window, "title.size", 1) && !SetWindowInt(window, "", 1);
+	bool lazy = (window.themeVisits == 0);
+
+	// schema members with own schema
+	Transform transform;
+	float x = 0.0f;
+	bool fieldHit = nap::VisitFieldPath(transform, "position.x", [&x](std::string_view name, auto& member){
+		if constexpr(std::is_same_v<std::remove_const_t<std::remove_reference_t<decltype(member)>>, float>){
+			member = 3.0f;
+			x = member;
+			return name == "x";
+		}
+		return false;
+	});
+	fieldHit = fieldHit && transform.position.x == 3.0f && x == 3.0f && transform.scale.x == 1.0f;
+	auto never = [](std::string_view, auto&){return true;};
+	bool fieldMisses = !nap::VisitFieldPath(transform, "position.z", never) && !nap::VisitFieldPath(transform, "rotation.x", never)
+		&& !nap::VisitFieldPath(transform, "name.x", never);
+
+	Property::Visitor scaleSetter([](const Property& property){
+		float value = 2.5f;
+		Property::any_type input = Property::interface::make_any(value);
+		property.write(input);
+		return true;
+	});
+	bool propertyHit = nap::VisitPropertyPath<Property>(scaleSetter, transform, "scale.y") && transform.scale.y == 2.5f && transform.scale.x == 1.0f;
+	// members with own schema are nested properties of property visit as well
+	bool schemaNested = nap::VisitPath<Property>(scaleSetter, "position.y", [&transform](const Property::Visitor& visitor){
+		nap::VisitProperties<Property>(visitor, transform);
+	});
+	propertyHit = propertyHit && schemaNested && transform.position.y == 2.5f;
+	bool propertyMisses = !nap::VisitPropertyPath<Property>(scaleSetter, transform, "scale.w") && !nap::VisitPropertyPath<Property>(scaleSetter, transform, "size.y");
+
+	std::cout<<"Path hit: "<<(hit ? "yes" : "no")<<'\n';
+	std::cout<<"Path misses reported: "<<(misses ? "yes" : "no")<<'\n';
+	std::cout<<"Other subtrees not visited: "<<(lazy ? "yes" : "no")<<'\n';
+	std::cout<<"Field path hit: "<<(fieldHit ? "yes" : "no")<<'\n';
+	std::cout<<"Field path misses reported: "<<(fieldMisses ? "yes" : "no")<<'\n';
+	std::cout<<"Property path hit: "<<(propertyHit ? "yes" : "no")<<'\n';
+	std::cout<<"Property path misses reported: "<<(propertyMisses ? "yes" : "no")<<'\n';
+	return (hit && misses && lazy && fieldHit && fieldMisses && propertyHit && propertyMisses) ? 0 : 1;
+}
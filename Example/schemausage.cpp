@@ -0,0 +1,69 @@
+#include <iostream>
+#include <string>
+
+#include "../propertydefaults.hpp"
+#include "../propertyconstraint.hpp"
+#include "../propertyschema.hpp"
+
+#define SCHEMA(...) \
+static constexpr auto propertySchema(){\
+using namespace nap;\
+return Schema(__VA_ARGS__);}
+
+class Transform{
+	public:
+	SCHEMA(
+		Field("name", &Transform::name),
+		Field("x", &Transform::x),
+		Field("y", &Transform::y),
+		Field("scale", &Transform::scale, constraint::Range(0.0, 10.0))
+	)
+
+	private:
+	std::string name = "Transform";
+	float x = 1.0f;
+	float y = 2.0f;
+	double scale = 0.5;
+};
+
+int main(){
+	Transform transform;
+
+	// statically typed walk, each member is passed with its own type
+	nap::VisitFields(transform, [](std::string_view name, auto& member){
+		std::cout<<"\tField["<<name<<"]: "<<member<<'\n';
+		return true;
+	});
+
+	std::cout<<"\n<------------------------------------->\n\n";
+
+	// classic property visitor over the same schema
+	auto scaleFloats = [](const nap::PropertyRef& property){
+		using prop = nap::PropertyRef::interface;
+		nap::PropertyRef::any_type value;
+		property.read(value);
+
+		if(prop::is_any<float>(value)){
+			float scaled = prop::cast_any<float>(value) * 10;
+			value = prop::make_any<float&>(scaled);
+			property.write(value);
+		}
+		return true;
+	};
+	nap::PropertyRef::Visitor visitor(scaleFloats);
+	nap::VisitProperties<nap::PropertyRef>(visitor, transform);
+
+	const Transform& constTransform = transform;
+	nap::VisitFields(constTransform, [](std::string_view name, const auto& member){
+		std::cout<<"\tField["<<name<<"]: "<<member<<'\n';
+		return true;
+	});
+
+	std::cout<<"\n<------------------------------------->\n\n";
+
+	// declared constraints, checked without visiting unconstrained fields
+	nap::Validate(constTransform, [](std::size_t, std::string_view name){
+		std::cout<<"\tInvalid field: "<<name<<'\n';
+		return true;
+	});
+}
@@ -0,0 +1,140 @@
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../propertybinary.hpp"
+#include "../propertydefaults.hpp"
+#include "../propertyschema.hpp"
+#include "../propertysnapshot.hpp"
+
+class Vector2{
+	public:
+	static constexpr auto propertySchema(){
+		return nap::Schema(
+			nap::Field("x", &Vector2::x),
+			nap::Field("y", &Vector2::y)
+		);
+	}
+
+	bool operator==(const Vector2& other) const{return x == other.x && y == other.y;}
+
+	float x = 0.0f;
+	float y = 0.0f;
+};
+
+class Unit{
+	public:
+	static constexpr auto propertySchema(){
+		return nap::Schema(
+			nap::Field("name", &Unit::name),
+			nap::Field("id", &Unit::id),
+			nap::Field("position", &Unit::position),
+			nap::Field("velocity", &Unit::velocity),
+			nap::Field("alive", &Unit::alive)
+		);
+	}
+
+	bool operator==(const Unit& other) const{
+		return name == other.name && id == other.id && position == other.position && velocity == other.velocity && alive == other.alive;
+	}
+
+	std::string name;
+	int id = 0;
+	Vector2 position;
+	Vector2 velocity;
+	bool alive = false;
+};
+
+/**
+ * Collects readable properties of object in visiting order, descending into nested properties as snapshot does.
+ **/
+class LeafCollector{
+	public:
+	bool operator()(const nap::Property& property){
+		if(property.isNested()){
+			return property.visitChildren(nap::Property::Visitor::Reference(*this));
+		}
+		if(property.isReadable()){
+			leaves.push_back(property);
+		}
+		return true;
+	}
+
+	std::vector<nap::Property> leaves;
+};
+
+/**
+ * Writes read only properties of snapshot object into matching properties of target object.
+ **/
+class Loader{
+	public:
+	explicit Loader(std::vector<nap::Property>& leaves) : m_leaves(leaves){}
+
+	bool operator()(const nap::Property& property){
+		using prop = nap::Property::interface;
+		if(m_next >= m_leaves.size() || m_leaves[m_next].name() != property.name()){
+			return false;
+		}
+		nap::Property::any_type value;
+		property.read(value);
+		// strings are presented as views into the mapping
+		if(prop::is_any<std::string_view>(value)){
+			std::string text(prop::cast_any<std::string_view>(value));
+			value = prop::make_any(text);
+			m_leaves[m_next++].write(value);
+			return true;
+		}
+		m_leaves[m_next++].write(value);
+		return true;
+	}
+
+	private:
+	std::vector<nap::Property>& m_leaves;
+	std::size_t m_next = 0;
+};
+
+int main(){
+	using nap::Property;
+	const char* path = "snapshotusage.snapshot";
+
+	std::vector<Unit> units(100);
+	for(std::size_t i = 0; i < units.size(); ++i){
+		units[i].name = "Unit " + std::to_string(i);
+		units[i].id = static_cast<int>(i);
+		units[i].position = Vector2{static_cast<float>(i), static_cast<float>(i) * 2.0f};
+		units[i].velocity = Vector2{-1.0f, static_cast<float>(i % 3)};
+		units[i].alive = (i % 2 == 0);
+	}
+
+	nap::SnapshotWriter<Property> writer;
+	for(Unit& unit : units){
+		nap::VisitProperties<Property>(Property::Visitor::Reference(writer), unit);
+		writer.nextObject();
+	}
+	bool saved = writer.save(path);
+
+	nap::BinarySchemaHash<Property> hash;
+	nap::VisitProperties<Property>(Property::Visitor::Reference(hash), units.front());
+
+	nap::Snapshot<Property> snapshot;
+	bool opened = saved && snapshot.open(path) && snapshot.size() == units.size() && snapshot.schemaHash() == hash.hash();
+	// name, id, alive and both coordinates of both nested vectors
+	bool flattened = opened && snapshot.fieldCount() == 7;
+
+	bool loaded = opened;
+	for(std::size_t i = 0; loaded && i < snapshot.size(); ++i){
+		Unit unit;
+		LeafCollector collector;
+		nap::VisitProperties<Property>(Property::Visitor::Reference(collector), unit);
+		Loader loader(collector.leaves);
+		loaded = snapshot.visit(Property::Visitor::Reference(loader), i) && (unit == units[i]);
+	}
+	snapshot.close();
+	std::remove(path);
+
+	std::cout<<"Snapshot of "<<units.size()<<" objects saved and mapped: "<<(opened ? "yes" : "no")<<'\n';
+	std::cout<<"Nested members stored in place of parent: "<<(flattened ? "yes" : "no")<<'\n';
+	std::cout<<"Loaded objects match: "<<(loaded ? "yes" : "no")<<'\n';
+	return (opened && flattened && loaded) ? 0 : 1;
+}
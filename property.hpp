@@ -22,23 +22,245 @@
 
 #pragma once
 
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <type_traits>
+
+// changes inline function bodies, so it has to be defined in all translation units or in none (@see propertyinstrumentation.hpp)
+#ifdef NAP_INSTRUMENTATION
+#include "propertyinstrumentation.hpp"
+// each hook takes static call site id, which indexes per thread cache of counters
+#define NAP_INSTRUMENT_SCOPE(operation, name) \
+	static const std::size_t napInstrumentationScopeSite = ::nap::instrumentation::detail::NextCallSite(); \
+	::nap::instrumentation::Scope napInstrumentationScope(napInstrumentationScopeSite, ::nap::instrumentation::Operation::operation, std::string_view(name))
+#define NAP_INSTRUMENT_BYTES(operation, name, bytes) \
+	static const std::size_t napInstrumentationBytesSite = ::nap::instrumentation::detail::NextCallSite(); \
+	::nap::instrumentation::AddBytes(napInstrumentationBytesSite, ::nap::instrumentation::Operation::operation, std::string_view(name), bytes)
+#else
+#define NAP_INSTRUMENT_SCOPE(operation, name)
+#define NAP_INSTRUMENT_BYTES(operation, name, bytes)
+#endif
 
 /** Named property */
 namespace nap{
 
+/**
+ * Static metadata of value type, single instance exists per type, so its address is stable id of the type.
+ **/
+struct TypeInfo{
+	std::size_t size;
+	std::size_t alignment;
+	bool triviallyCopyable;
+};
+
 namespace detail{
 
+template<typename T>
+inline constexpr TypeInfo type_info_of{sizeof(T), alignof(T), std::is_trivially_copyable_v<T>};
+
+template<class Interface, typename T>
+/**
+ * Whether interface can hold values of T, true unless interface is limited to closed set of types (e.g. VariantInterface).
+ * Generic type tables skip codecs of types which are not supported, so they compile for such interfaces.
+ **/
+struct interface_supports : std::true_type{};
+template<class Interface, typename T>
+inline constexpr bool interface_supports_v = interface_supports<Interface, std::remove_cv_t<T>>::value;
+
 template <typename T>
 inline constexpr bool is_const = std::is_const_v<typename std::remove_pointer<typename std::remove_reference<T>::type>::type>;
 
+template<class Callable, class PropertyT, typename = void>
+struct has_visit : std::false_type{};
+template<class Callable, class PropertyT>
+struct has_visit<Callable, PropertyT, std::void_t<decltype(std::declval<Callable&>().visit(std::declval<const PropertyT&>()))>> : std::true_type{};
+
+template<class Callable, class PropertyT>
+inline constexpr bool is_visitor_v = has_visit<Callable, PropertyT>::value || std::is_invocable_r_v<bool, Callable&, const PropertyT&>;
+
+template<class Callable, class PropertyT>
+/**
+ * Calls visitor with property, type erased Visitor (or any type with such visit member) via its visit member,
+ *  any other callable directly, so its body can be inlined into visiting loop.
+ **/
+bool InvokeVisitor(Callable& visitor, const PropertyT& property){
+	if constexpr(has_visit<Callable, PropertyT>::value){
+		return visitor.visit(property);
+	}
+	else{
+		static_assert(std::is_invocable_r_v<bool, Callable&, const PropertyT&>, "visitor has to be callable as bool(const PropertyT&)");
+		NAP_INSTRUMENT_SCOPE(Visit, property.name());
+		return visitor(property);
+	}
+}
+
 template <typename... Args> 
 struct are_const{
   static constexpr bool value {(is_const<Args> || ...)};
 };
+
+/**
+ * Refference to single bit of dirty mask owned by object, which is set when tracked property is written.
+ **/
+struct DirtyFlag{
+	std::uint64_t* word = nullptr;
+	std::uint64_t mask = 0;
+
+	void set() const{
+		if(word != nullptr){
+			*word |= mask;
+		}
+	}
+	bool isSet() const{return (word != nullptr) && ((*word & mask) != 0);}
+};
+
+template<class Signature>
+class FunctionRef;
+
+template<class R, class... Args>
+/**
+ * Non-owning reference to callable, made of object pointer and invoker pointer.
+ * It is trivially copyable and never allocates,
+ *  but referenced callable has to outlive the FunctionRef (e.g. lambda passed into property list).
+ * 
+ * @note FunctionRef made from temporary (e.g. FunctionRef<void()> ref([&]{...});) dangles as soon as the full expression ends,
+ *  it is safe only as parameter type consumed within the call. PropertyTemplate refuses temporaries under FunctionRefStorage.
+ **/
+class FunctionRef<R(Args...)>{
+public: // functions
+	FunctionRef() = default;
+	FunctionRef(std::nullptr_t){}
+
+	template<class Callable, typename = std::enable_if_t<
+		!std::is_same_v<std::decay_t<Callable>, FunctionRef> &&
+		!std::is_function_v<std::remove_reference_t<Callable>> &&
+		std::is_invocable_r_v<R, Callable&, Args...>>
+	>
+	FunctionRef(Callable&& callable) : 
+	m_object(const_cast<void*>(static_cast<const void*>(std::addressof(callable)))),
+	m_invoke(
+		[](void* object, Args... args) -> R{
+			return (*static_cast<std::remove_reference_t<Callable>*>(object))(std::forward<Args>(args)...);
+		}
+	)
+	{}
+
+	template<auto Invoker, class T>
+	/**
+	 * Binds object to invoker without any intermediate callable.
+	 * 
+	 * @param object refference to object which will be passed into invoker as first argument.
+	 * 
+	 * @return FunctionRef calling Invoker(object, args...).
+	 **/
+	static FunctionRef Bind(T& object){
+		FunctionRef ref;
+		ref.m_object = const_cast<void*>(static_cast<const void*>(std::addressof(object)));
+		ref.m_invoke = [](void* obj, Args... args) -> R{
+			return Invoker(*static_cast<T*>(obj), std::forward<Args>(args)...);
+		};
+		return ref;
+	}
+
+	R operator()(Args... args) const{return m_invoke(m_object, std::forward<Args>(args)...);}
+
+	explicit operator bool() const{return (m_invoke != nullptr);}
+	bool operator==(std::nullptr_t) const{return (m_invoke == nullptr);}
+	bool operator!=(std::nullptr_t) const{return (m_invoke != nullptr);}
+
+private: // members
+	void* m_object = nullptr;
+	R (*m_invoke)(void*, Args...) = nullptr;
+};
+
+/**
+ * Storage policy keeping read/write/visit functors as owning std::function.
+ **/
+struct FunctionStorage{
+	template<class Signature>
+	using function = std::function<Signature>;
+
+	static constexpr bool owning = true;
+
+	template<class Signature, auto Invoker, class T>
+	static function<Signature> bind(T& object){
+		return [&object](auto&... args){ return Invoker(object, args...);};
+	}
+
+	template<class Signature, class Callable>
+	static function<Signature> reference(Callable& callable){
+		return std::ref(callable);
+	}
+};
+
+/**
+ * Storage policy keeping read/write/visit functors as non-owning FunctionRef.
+ * Properties are then trivially copyable and visiting never allocates,
+ *  as long as custom functors and visitor callables outlive the properties referencing them.
+ **/
+struct FunctionRefStorage{
+	template<class Signature>
+	using function = FunctionRef<Signature>;
+
+	static constexpr bool owning = false;
+
+	template<class Signature, auto Invoker, class T>
+	static function<Signature> bind(T& object){
+		return function<Signature>::template Bind<Invoker>(object);
+	}
+
+	template<class Signature, class Callable>
+	static function<Signature> reference(Callable& callable){
+		return function<Signature>(callable);
+	}
+};
+
+template<class T>
+struct is_function_ref : std::false_type{};
+template<class Signature>
+struct is_function_ref<FunctionRef<Signature>> : std::true_type{};
+
+template<class StoragePolicy, class Callable>
+/**
+ * Whether callable would be referenced after its destruction when passed into property or visitor,
+ *  true for temporary callables (other than FunctionRef and nullptr) under non-owning storage policy.
+ **/
+inline constexpr bool is_dangling_callable_v = !StoragePolicy::owning && !std::is_lvalue_reference_v<Callable> &&
+	!std::is_same_v<std::decay_t<Callable>, std::nullptr_t> && !is_function_ref<std::decay_t<Callable>>::value;
+}
+
+#if defined(__cpp_concepts)
+/**
+ * Visitor accepted by Visitor::visit overloads, either type erased Visitor or any callable bool(const PropertyT&).
+ **/
+template<class Callable, class PropertyT>
+concept PropertyVisitor = detail::is_visitor_v<std::remove_reference_t<Callable>, PropertyT>;
+#endif
+
+namespace detail{
+template<class Callable, class PropertyT>
+/**
+ * Constrains overloads taking visitor to Visitor or callable bool(const PropertyT&), via PropertyVisitor concept when available.
+ **/
+using enable_if_visitor_t = std::enable_if_t<
+#if defined(__cpp_concepts)
+	PropertyVisitor<Callable, PropertyT>
+#else
+	is_visitor_v<std::remove_reference_t<Callable>, PropertyT>
+#endif
+>;
 }
 
-template<class InterfaceImpl>
+template<typename T>
+/**
+ * @return metadata of type T (cv-qualifiers are ignored), which address can be compared as type id.
+ **/
+constexpr const TypeInfo* TypeInfoOf(){
+	return &detail::type_info_of<std::remove_cv_t<T>>;
+}
+
+template<class InterfaceImpl, class StoragePolicy = detail::FunctionStorage>
 /**
  * Property template is used to interact with named members(and/or other getters/setters) of a class objects.
  * (but this is not limited to object only an intended use, this can be used also in cases of sharing local context without using any object)
@@ -55,14 +277,41 @@ template<class InterfaceImpl>
  *   * any_type read(const type)            - used by PropertyTemplate to read const type type value into any type
  *   * void write(type&, any_type&)         - used by PropertyTemplate to write any type value into type value
  *  Note: type or required type is meant as input type before its contained in any_type and when its returned from any_type
+ * 
+ * Storage policy decides how read/write/visit functors are kept:
+ *   * detail::FunctionStorage    - owning std::function (default).
+ *   * detail::FunctionRefStorage - non-owning detail::FunctionRef, which never allocates.
  **/
 class PropertyTemplate{
 public: //type definitions
 	class Visitor{
 	public: // functions
-		using PropertyVisitFunc = std::function<bool(const PropertyTemplate&)>;
+		using PropertyVisitFunc = typename StoragePolicy::template function<bool(const PropertyTemplate&)>;
 		
+		/**
+		 * @note With detail::FunctionRefStorage, visitor only refferences propertyVistFunc,
+		 *  so passed callable has to outlive the visitor.
+		 **/
 		Visitor(const PropertyVisitFunc& propertyVistFunc) : m_visitProperty(propertyVistFunc){}
+		/**
+		 * Temporary callable would dangle with detail::FunctionRefStorage, pass named callable instead.
+		 **/
+		template<class Callable, typename = std::enable_if_t<
+			!std::is_same_v<std::decay_t<Callable>, Visitor> && std::is_constructible_v<PropertyVisitFunc, Callable> &&
+			detail::is_dangling_callable_v<StoragePolicy, Callable>>
+		>
+		Visitor(Callable&& callable) = delete;
+
+		template<class Callable>
+		/**
+		 * Makes visitor which refferences callable instead of copying it,
+		 *  so stateful visitors (e.g. serializers) keep their state in callable.
+		 * 
+		 * @param callable functor which has to outlive returned visitor.
+		 **/
+		static Visitor Reference(Callable& callable){
+			return Visitor(StoragePolicy::template reference<bool(const PropertyTemplate&)>(callable));
+		}
 		/**
 		 * Executes visitor functor and passing property as argument. 
 		 * 
@@ -71,42 +320,44 @@ public: //type definitions
 		 * @return return passed return value of functor.
 		 **/
 		bool visit(const PropertyTemplate& property) const {
+			NAP_INSTRUMENT_SCOPE(Visit, property.name());
 			return m_visitProperty(property);
 		}
 
-		template<class Callable, class PropertyArray>
+		template<class Callable, class PropertyArray, typename = detail::enable_if_visitor_t<Callable, PropertyTemplate>>
 		/**
 		 * Run visitor functor over container that supports usage in range for loop(foreach).
 		 * 
-		 * @param visitor functor which will be called for each property.
+		 * @param visitor Visitor, or any callable with signature bool(const PropertyTemplate&) which is then called directly,
+		 *  so the loop is specialized for it and its body can be inlined.
 		 * @param properties container which support range loop(foreach) operation.
 		 * 
 		 * @return true when all visitor calls returned true, otherwise false
 		 * 
 		 * @note First call of of visitor which returns false will also break the loop.
 		 **/
-		static bool visit(const Callable& visitor, const PropertyArray& properties){
+		static bool visit(Callable&& visitor, const PropertyArray& properties){
 			for(const auto& property : properties){
-				if(visitor.visit(property) == false){
+				if(detail::InvokeVisitor(visitor, property) == false){
 					return false;
 				}
 			}
 			return true;
 		}
-		template<class Callable>
+		template<class Callable, typename = detail::enable_if_visitor_t<Callable, PropertyTemplate>>
 		/**
 		 * Run visitor functor over initializer list of properties.
 		 * 
-		 * @param visitor functor which will be called for each property.
+		 * @param visitor Visitor, or any callable with signature bool(const PropertyTemplate&) which is then called directly.
 		 * @param ilProperties initializer list which takes list initialization such as e.g. {1,2,3..}.
 		 * 
 		 * @return true when all visitor calls returned true, otherwise false
 		 * 
 		 * @note First call of of visitor which returns false will also break the loop.
 		 **/
-		static bool visit(const Callable& visitor, std::initializer_list<PropertyTemplate> ilProperties){
+		static bool visit(Callable&& visitor, std::initializer_list<PropertyTemplate> ilProperties){
 			for(const auto& property : ilProperties){
-				if(visitor.visit(property) == false){
+				if(detail::InvokeVisitor(visitor, property) == false){
 					return false;
 				}
 			}
@@ -118,12 +369,17 @@ public: //type definitions
 	};
 
 	using interface         = InterfaceImpl;
+	using storage_policy    = StoragePolicy;
 	using string_type       = typename interface::string_type;
 	using string_type_ref   = typename interface::string_type_ref;
 	using any_type          = typename interface::any_type;
 
-    using WriteFunction     = std::function<void(any_type& entry)>;
-	using ReadFunction      = std::function<void(any_type& entry)>;
+    using WriteFunction     = typename StoragePolicy::template function<void(any_type& entry)>;
+	using ReadFunction      = typename StoragePolicy::template function<void(any_type& entry)>;
+	using ChildrenFunction  = typename StoragePolicy::template function<bool(const Visitor& visitor)>;
+
+public: // static members
+	static constexpr std::size_t npos = static_cast<std::size_t>(-1);
 	
 public: // static functions
 	// helpers
@@ -153,32 +409,80 @@ public: // static functions
 		return member;
 	}
 
+	// default read/write functors of member properties
+	template<typename T>
+	static void ReadConstMember(const T& constMember, any_type& entry){
+		entry = interface::template read<T>(constMember);
+	}
+	template<typename T>
+	static void ReadMember(T& member, any_type& entry){
+		entry = interface::template read<T>(member);
+	}
+	template<typename T>
+	static void WriteMember(T& member, any_type& entry){
+		interface::template write<T>(member, entry);
+	}
+
+	template<class Callable>
+	/**
+	 * Makes nested property, which value is itself list of properties presented on demand.
+	 * Children are not constructed until visitor descends via visitChildren.
+	 * 
+	 * @param name property name.
+	 * @param children functor with signature bool(const Visitor& visitor), which visits child properties
+	 *  e.g. [this](const Property::Visitor& visitor){ return Property::Visitor::visit(visitor, {...});}.
+	 * 
+	 * @return nested property.
+	 * 
+	 * @note With detail::FunctionRefStorage, children functor has to outlive the property.
+	 **/
+	static PropertyTemplate Nested(string_type name, const Callable& children){
+		return PropertyTemplate(name, ChildrenFunction(children), NestedTag{});
+	}
+	/**
+	 * Temporary children functor would dangle with detail::FunctionRefStorage, pass named functor instead.
+	 **/
+	template<class Callable, typename = std::enable_if_t<
+		std::is_constructible_v<ChildrenFunction, Callable> && detail::is_dangling_callable_v<StoragePolicy, Callable>>
+	>
+	static PropertyTemplate Nested(string_type name, Callable&& children) = delete;
+	template<auto Invoker, class T>
+	/**
+	 * Makes nested property which children are presented by Invoker(object, visitor),
+	 *  without any intermediate functor to keep alive.
+	 * 
+	 * @see Nested
+	 **/
+	static PropertyTemplate Nested(string_type name, T& object){
+		return PropertyTemplate(name, StoragePolicy::template bind<bool(const Visitor&), Invoker>(object), NestedTag{});
+	}
+
 public: // member functions
 	PropertyTemplate(string_type name, const ReadFunction& readFunc, const WriteFunction& writeFunc) : m_name(name), m_read(readFunc), m_write(writeFunc) {}
+	/**
+	 * Temporary read/write functors would dangle with detail::FunctionRefStorage, pass named functors instead.
+	 **/
+	template<class Read, class Write, typename = std::enable_if_t<
+		std::is_constructible_v<ReadFunction, Read> && std::is_constructible_v<WriteFunction, Write> &&
+		(detail::is_dangling_callable_v<StoragePolicy, Read> || detail::is_dangling_callable_v<StoragePolicy, Write>)>
+	>
+	PropertyTemplate(string_type name, Read&& readFunc, Write&& writeFunc) = delete;
 	PropertyTemplate(string_type name) : m_name(name), m_read(nullptr), m_write(nullptr) {}
 
 	template<typename T>
 	PropertyTemplate(string_type name, const T& constMember) : m_name(name),
-	m_read(
-		[&constMember](typename interface::any_type& entry){
-			entry = interface::template read<T>(constMember);
-		}
-	), 
-	m_write({})
+	m_read(StoragePolicy::template bind<void(any_type&), &ReadConstMember<T>>(constMember)), 
+	m_write(nullptr),
+	m_address(std::addressof(constMember)),
+	m_type(TypeInfoOf<T>())
 	{}
 
 	template<typename T>
 	PropertyTemplate(string_type name, T& member) : m_name(name), 
-	m_read(
-		[&member](typename interface::any_type& entry){
-			entry = interface::template read<T>(member);
-		}
-	), 
-	m_write(
-		[&member](typename interface::any_type& entry){
-			interface::template write<T>(member, entry);
-		}
-	) 
+	m_read(StoragePolicy::template bind<void(any_type&), &ReadMember<T>>(member)), 
+	m_write(StoragePolicy::template bind<void(any_type&), &WriteMember<T>>(member)),
+	m_address(std::addressof(member)),
+	m_type(TypeInfoOf<T>())
 	{}
 	/**
 	 * Returns propert name.
@@ -192,13 +496,20 @@ public: // member functions
 	 * 
 	 * @param entry non-const refference to any_type variable.
 	 **/
-	void read(any_type& entry) const{m_read(entry);}
+	void read(any_type& entry) const{
+		NAP_INSTRUMENT_SCOPE(Read, m_name);
+		m_read(entry);
+	}
 	/**
 	 * Passes const refferenc of entry to write functor.
 	 * 
 	 * @param entry const refference to any_type variable.
 	 **/
-	void write(any_type& entry) const{m_write(entry);}
+	void write(any_type& entry) const{
+		NAP_INSTRUMENT_SCOPE(Write, m_name);
+		m_write(entry);
+		m_dirty.set();
+	}
 	/**
 	 * Checks if read functor was provided.
 	 * 
@@ -219,11 +530,121 @@ public: // member functions
 	 * @note This has use case when you need to pass static string (e.g. class name),
 	 *  or to be used as a separator/category when defining properties.
 	 **/
-	bool isNameOnly() const{return (!isReadable() && !isWritable());}
+	bool isNameOnly() const{return (!isReadable() && !isWritable() && !isNested());}
+	/**
+	 * Checks if property has child properties.
+	 * 
+	 * @return true when property was made by Nested, otherwise false.
+	 **/
+	bool isNested() const{return (m_children != nullptr);}
+	/**
+	 * Presents child properties of nested property to visitor.
+	 * 
+	 * @param visitor visitor which will be called for each child property.
+	 * 
+	 * @return return value of children functor, or true when property is not nested.
+	 **/
+	bool visitChildren(const Visitor& visitor) const{
+		return isNested() ? m_children(visitor) : true;
+	}
+	/**
+	 * Checks if property was constructed directly from variable (e.g. member) refference,
+	 *  so its read and write have no side effects besides accessing that variable.
+	 * 
+	 * @return true when default read/write functors are used, otherwise false.
+	 **/
+	bool isVariable() const{return (m_address != nullptr);}
+
+	/**
+	 * Returns static metadata of value type, known without reading the property.
+	 * 
+	 * @return metadata captured from member type, or set by typed, otherwise nullptr (e.g. custom functors, nested properties).
+	 **/
+	const TypeInfo* type() const{return m_type;}
+	template<typename T>
+	/**
+	 * @return true when metadata of property is metadata of T, cv-qualifiers are ignored.
+	 **/
+	bool isType() const{return (m_type == TypeInfoOf<T>());}
+	/**
+	 * @return true when property can be read but not written, e.g. constructed from const member.
+	 **/
+	bool isConst() const{return (isReadable() && !isWritable());}
+	/**
+	 * @return address of variable which property was constructed from, otherwise nullptr.
+	 **/
+	const void* address() const{return m_address;}
+	/**
+	 * Computes offset of variable within object, so the same member of other objects can be accessed directly.
+	 * 
+	 * @param object object which is expected to contain the variable.
+	 * 
+	 * @return offset in bytes, or npos when property is not variable or variable is not within object.
+	 **/
+	template<class Object>
+	std::size_t offsetIn(const Object& object) const{
+		if(m_address == nullptr || m_type == nullptr){
+			return npos;
+		}
+		const std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(std::addressof(object));
+		const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(m_address);
+		if(address < begin || address + m_type->size > begin + sizeof(Object)){
+			return npos;
+		}
+		return static_cast<std::size_t>(address - begin);
+	}
+	template<typename T>
+	/**
+	 * Declares value type of property with custom functors, so its metadata is known without reading.
+	 * Meant to be chained when declaring properties e.g. Property("Range", readFunc, writeFunc).typed<Range>().
+	 * 
+	 * @return this property.
+	 **/
+	PropertyTemplate&& typed() &&{
+		m_type = TypeInfoOf<T>();
+		return std::move(*this);
+	}
+
+	/**
+	 * Enables change tracking, each write will then set passed dirty flag.
+	 * Meant to be chained when declaring properties e.g. Property("x", x).tracked(dirtyMask.flag(0)).
+	 * 
+	 * @param flag dirty flag of this property, usually obtained from nap::DirtyMask.
+	 * 
+	 * @return this property.
+	 **/
+	PropertyTemplate&& tracked(detail::DirtyFlag flag) &&{
+		m_dirty = flag;
+		return std::move(*this);
+	}
+	/**
+	 * Sets dirty flag of tracked property, used when member was changed directly and not via write.
+	 **/
+	void markDirty() const{m_dirty.set();}
+	/**
+	 * Checks if tracked property was written since its dirty flag was cleared.
+	 * 
+	 * @return true when property is tracked and its dirty flag is set, otherwise false.
+	 **/
+	bool isDirty() const{return m_dirty.isSet();}
+	/**
+	 * @return true when change tracking was enabled for property.
+	 **/
+	bool isTracked() const{return (m_dirty.word != nullptr);}
+
+private: // type definitions
+	struct NestedTag{};
+
+private: // functions
+	PropertyTemplate(string_type name, const ChildrenFunction& children, NestedTag) : m_name(name), m_read(nullptr), m_write(nullptr), m_children(children) {}
 
 private: // members
 	const string_type_ref m_name;
 	const ReadFunction m_read;
 	const WriteFunction m_write;
+	const ChildrenFunction m_children = nullptr;
+	const void* const m_address = nullptr;
+	const TypeInfo* m_type = nullptr;
+	detail::DirtyFlag m_dirty;
 };
 }
\ No newline at end of file
@@ -0,0 +1,158 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#pragma once
+#include "property.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace nap{
+
+/**
+ * Monotonic arena for values and temporaries created during visit (e.g. new values passed to write),
+ *  which are all destroyed and released in one step by release() or when arena goes out of scope.
+ * Initial block is allocated once and reused after each release, so repeated visits which fit into it never allocate.
+ * 
+ * Usage:
+ *   nap::VisitArena arena;
+ *   Property::Visitor visitor([&arena](const Property& property){
+ *       Property::any_type value = arena.makeStringAny<Property>("new value");
+ *       property.write(value); // assigned into std::string member
+ *       return true;
+ *   });
+ *   object.propertiesFunc(visitor);
+ *   arena.release();
+ **/
+class VisitArena{
+public: // functions
+	/**
+	 * @param initialCapacity size of initial block in bytes, further blocks are allocated from upstream when it is exhausted.
+	 * @param upstream memory resource used for initial and further blocks.
+	 **/
+	explicit VisitArena(std::size_t initialCapacity = 16 * 1024, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) :
+	m_upstream(upstream),
+	m_initialCapacity(initialCapacity < MinimalCapacity ? MinimalCapacity : initialCapacity),
+	m_initial(upstream->allocate(m_initialCapacity, alignof(std::max_align_t))),
+	m_resource(m_initial, m_initialCapacity, upstream)
+	{}
+
+	VisitArena(const VisitArena&) = delete;
+	VisitArena& operator=(const VisitArena&) = delete;
+
+	~VisitArena(){
+		release();
+		m_upstream->deallocate(m_initial, m_initialCapacity, alignof(std::max_align_t));
+	}
+
+	template<class T, class... Args>
+	/**
+	 * Constructs object in arena, its destructor is run by release (when it is not trivially destructible).
+	 * 
+	 * @return refference to object valid until release.
+	 **/
+	T& make(Args&&... args){
+		void* storage = m_resource.allocate(sizeof(T), alignof(T));
+		T* object = ::new(storage) T(std::forward<Args>(args)...);
+		if constexpr(!std::is_trivially_destructible_v<T>){
+			void* cleanupStorage = m_resource.allocate(sizeof(Cleanup), alignof(Cleanup));
+			m_cleanups = ::new(cleanupStorage) Cleanup{&Destroy<T>, object, m_cleanups};
+		}
+		return *object;
+	}
+
+	template<class PropertyT, class T, class... Args>
+	/**
+	 * Constructs object in arena and wraps it to any_type of PropertyT interface as mutable refference,
+	 *  so write can move from it.
+	 **/
+	typename PropertyT::any_type makeAny(Args&&... args){
+		return PropertyT::interface::template make_any<T&>(make<T>(std::forward<Args>(args)...));
+	}
+
+	/**
+	 * Makes temporary string which characters are also allocated in arena,
+	 *  for use within visit (std::string properties are written from makeStringAny).
+	 **/
+	std::pmr::string& makeString(std::string_view text){
+		return make<std::pmr::string>(text, resource());
+	}
+
+	template<class PropertyT>
+	/**
+	 * Copies text into string made in arena and wraps view of it to any_type of PropertyT interface as const std::string_view,
+	 *  which DefaultInterface assigns into std::string properties (into capacity of the target).
+	 * Characters live in arena as well, so repeated visits which fit into initial block do not allocate once targets are warmed up.
+	 **/
+	typename PropertyT::any_type makeStringAny(std::string_view text){
+		const std::pmr::string& string = makeString(text);
+		return PropertyT::interface::template make_any<const std::string_view&>(make<std::string_view>(string));
+	}
+
+	/**
+	 * Runs destructors of objects made in arena in reverse order and releases all memory,
+	 *  except of initial block which is reused.
+	 **/
+	void release(){
+		while(m_cleanups != nullptr){
+			Cleanup* cleanup = m_cleanups;
+			m_cleanups = cleanup->next;
+			cleanup->destroy(cleanup->object);
+		}
+		m_resource.release();
+	}
+
+	/**
+	 * @return memory resource of arena, usable with pmr containers living shorter than next release.
+	 **/
+	std::pmr::memory_resource* resource(){return &m_resource;}
+
+private: // type definitions
+	struct Cleanup{
+		void (*destroy)(void*);
+		void* object;
+		Cleanup* next;
+	};
+
+private: // static members
+	static constexpr std::size_t MinimalCapacity = 256;
+
+private: // static functions
+	template<class T>
+	static void Destroy(void* object){
+		static_cast<T*>(object)->~T();
+	}
+
+private: // members
+	std::pmr::memory_resource* m_upstream;
+	std::size_t m_initialCapacity;
+	void* m_initial;
+	std::pmr::monotonic_buffer_resource m_resource;
+	Cleanup* m_cleanups = nullptr;
+};
+}
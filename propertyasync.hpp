@@ -0,0 +1,371 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#pragma once
+#include "property.hpp"
+#include "propertybinary.hpp"
+#include "propertyschema.hpp"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <algorithm>
+#include <cassert>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <utility>
+#include <vector>
+
+namespace nap{
+
+/**
+ * Lazily started coroutine returning bool, used for asynchronous visits.
+ * Task is either resumed by VisitLoop, or awaited by another task which is then resumed when this task finishes.
+ **/
+class AsyncTask{
+public: // type definitions
+	struct promise_type{
+		AsyncTask get_return_object(){return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this));}
+		std::suspend_always initial_suspend() noexcept{return {};}
+		auto final_suspend() noexcept{
+			struct FinalAwaiter{
+				bool await_ready() noexcept{return false;}
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept{
+					if(handle.promise().live != nullptr){
+						--*handle.promise().live;
+					}
+					std::coroutine_handle<> continuation = handle.promise().continuation;
+					return continuation ? continuation : std::noop_coroutine();
+				}
+				void await_resume() noexcept{}
+			};
+			return FinalAwaiter{};
+		}
+		void return_value(bool value){result = value;}
+		void unhandled_exception(){exception = std::current_exception();}
+
+		bool result = false;
+		std::exception_ptr exception;
+		std::coroutine_handle<> continuation;
+		std::size_t* live = nullptr; // count of unfinished tasks of VisitLoop which spawned the task
+	};
+
+public: // functions
+	AsyncTask() = default;
+	AsyncTask(AsyncTask&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)){}
+	AsyncTask& operator=(AsyncTask&& other) noexcept{
+		if(this != &other){
+			destroy();
+			m_handle = std::exchange(other.m_handle, nullptr);
+		}
+		return *this;
+	}
+	~AsyncTask(){destroy();}
+
+	/**
+	 * Runs task until its next suspension point.
+	 **/
+	void resume(){
+		if(m_handle && !m_handle.done()){
+			m_handle.resume();
+		}
+	}
+	bool done() const{return !m_handle || m_handle.done();}
+	/**
+	 * @return value returned by finished task, rethrows exception escaped from the task.
+	 **/
+	bool result() const{
+		assert(m_handle && m_handle.done() && "result of empty or unfinished task");
+		if(m_handle.promise().exception){
+			std::rethrow_exception(m_handle.promise().exception);
+		}
+		return m_handle.promise().result;
+	}
+
+	// awaiting task starts it and resumes awaiting coroutine once it finishes
+	bool await_ready() const noexcept{return done();}
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept{
+		m_handle.promise().continuation = awaiting;
+		return m_handle;
+	}
+	bool await_resume() const{return result();}
+
+private: // functions
+	explicit AsyncTask(std::coroutine_handle<promise_type> handle) : m_handle(handle){}
+
+	void setLiveCounter(std::size_t* live){m_handle.promise().live = live;}
+
+	void destroy(){
+		if(m_handle){
+			m_handle.destroy();
+			m_handle = nullptr;
+		}
+	}
+
+private: // members
+	std::coroutine_handle<promise_type> m_handle;
+
+	friend class VisitLoop;
+};
+
+/**
+ * Single threaded event loop, interleaving many asynchronous visits.
+ * Suspended coroutines are posted back to loop by whatever they wait for (e.g. sink which accepted more data).
+ * 
+ * Usage:
+ *   VisitLoop loop;
+ *   for(Object& object : objects) loop.spawn(VisitFieldsAsync<Property>(object, writers[i]));
+ *   while(loop.pending()){ loop.runOnce(); poll sinks; }
+ **/
+class VisitLoop{
+public: // functions
+	/**
+	 * Takes ownership of task, which is started on next runOnce.
+	 * 
+	 * @return index of task for result, indices of tasks which results were taken are reused.
+	 **/
+	std::size_t spawn(AsyncTask task){
+		assert(!task.done() && "spawned task has to be unfinished");
+		task.setLiveCounter(&m_live);
+		++m_live;
+		std::size_t index = m_tasks.size();
+		if(!m_free.empty()){
+			index = m_free.back();
+			m_free.pop_back();
+			m_tasks[index] = std::move(task);
+		}
+		else{
+			m_tasks.push_back(std::move(task));
+		}
+		m_ready.push_back(Starter{index});
+		return index;
+	}
+	/**
+	 * Schedules suspended coroutine to be resumed on next runOnce.
+	 **/
+	void post(std::coroutine_handle<> handle){m_ready.push_back(Starter{npos, handle});}
+	/**
+	 * @return awaitable which suspends current coroutine and lets other ready coroutines run first.
+	 **/
+	auto yield(){
+		struct YieldAwaiter{
+			bool await_ready() const noexcept{return false;}
+			void await_suspend(std::coroutine_handle<> handle){loop.post(handle);}
+			void await_resume() const noexcept{}
+
+			VisitLoop& loop;
+		};
+		return YieldAwaiter{*this};
+	}
+
+	/**
+	 * Resumes all coroutines which were ready before the call.
+	 * 
+	 * @return number of resumed coroutines.
+	 **/
+	std::size_t runOnce(){
+		std::size_t count = m_ready.size();
+		for(std::size_t i = 0; i < count; ++i){
+			Starter next = m_ready.front();
+			m_ready.pop_front();
+			if(next.task != npos){
+				m_tasks[next.task].resume();
+			}
+			else{
+				next.handle.resume();
+			}
+		}
+		return count;
+	}
+	/**
+	 * Runs until no coroutine is ready, tasks waiting for external events may still be pending.
+	 **/
+	void run(){
+		while(runOnce() != 0){}
+	}
+
+	/**
+	 * @return true when any spawned task did not finish yet.
+	 **/
+	bool pending() const{return (m_live != 0);}
+	/**
+	 * Hands over result of finished task at index and drops the task, so its index can be reused by spawn.
+	 * 
+	 * @return value returned by the task, rethrows exception escaped from the task.
+	 **/
+	bool result(std::size_t index){
+		assert(index < m_tasks.size() && m_tasks[index].m_handle && m_tasks[index].done() && "result of unknown or unfinished task");
+		AsyncTask task = std::move(m_tasks[index]);
+		m_free.push_back(index);
+		return task.result();
+	}
+
+private: // type definitions
+	struct Starter{
+		std::size_t task;
+		std::coroutine_handle<> handle = nullptr;
+	};
+
+private: // static members
+	static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+private: // members
+	std::deque<AsyncTask> m_tasks; // deque keeps tasks in place while resumed task spawns others
+	std::vector<std::size_t> m_free; // indices of tasks which results were taken
+	std::deque<Starter> m_ready;
+	std::size_t m_live = 0;
+};
+
+template<class PropertyT, class PropertyArray, class AsyncVisitor>
+/**
+ * Visits properties of container, suspending on visitor.flush() after each batch of properties,
+ *  so slow sink does not block other visits running on the same thread.
+ * 
+ * @param visitor synchronous visitor bool(const PropertyT&) with member flush() returning awaitable of bool.
+ * @param batchSize number of properties visited between flushes.
+ * 
+ * @note properties and visitor are refferenced, so they have to outlive the task.
+ **/
+AsyncTask VisitAsync(const PropertyArray& properties, AsyncVisitor& visitor, std::size_t batchSize = 1){
+	std::size_t batched = 0;
+	for(const PropertyT& property : properties){
+		if(!visitor(property)){
+			co_return false;
+		}
+		if(++batched == batchSize){
+			batched = 0;
+			if(!co_await visitor.flush()){
+				co_return false;
+			}
+		}
+	}
+	co_return co_await visitor.flush();
+}
+
+template<class PropertyT, class Object, class AsyncVisitor>
+/**
+ * Visits fields of object schema as properties, constructing only one property at a time
+ *  and suspending on visitor.flush() after each batch.
+ * 
+ * @see VisitAsync
+ **/
+AsyncTask VisitFieldsAsync(Object& object, AsyncVisitor& visitor, std::size_t batchSize = 1){
+	constexpr std::size_t size = detail::schema_type<Object>::size;
+	std::size_t batched = 0;
+	for(std::size_t index = 0; index < size; ++index){
+		if(!schema_of<Object>.template visitProperty<PropertyT>(PropertyT::Visitor::Reference(visitor), object, index)){
+			co_return false;
+		}
+		if(++batched == batchSize){
+			batched = 0;
+			if(!co_await visitor.flush()){
+				co_return false;
+			}
+		}
+	}
+	co_return co_await visitor.flush();
+}
+
+template<class PropertyT, class PresentFunc>
+/**
+ * Copies properties presented via visitor into list, which asynchronous visit can walk after presenting returned.
+ * Properties have to own their functors, PropertyRef would refference functors destroyed with presented list.
+ * 
+ * @param present functor with signature void(const typename PropertyT::Visitor& visitor).
+ **/
+std::vector<PropertyT> CollectProperties(const PresentFunc& present){
+	static_assert(std::is_same_v<typename PropertyT::storage_policy, detail::FunctionStorage>, "collected properties have to own their functors");
+	std::vector<PropertyT> properties;
+	auto collect = [&properties](const PropertyT& property){
+		properties.push_back(property);
+		return true;
+	};
+	present(PropertyT::Visitor::Reference(collect));
+	return properties;
+}
+
+template<class PropertyT, class Sink, class TypeTable = detail::DefaultBinaryTypes<PropertyT>>
+/**
+ * Asynchronous visitor encoding values same as BinaryWriter (without schema hash header) into its chunk buffer,
+ *  which is written into sink on flush. Nested properties are encoded in place of their parent.
+ * 
+ * Sink has member write(const char* data, std::size_t size) returning awaitable of bool,
+ *  chunk is left untouched until that awaitable is resumed.
+ **/
+class AsyncStreamWriter{
+public: // functions
+	explicit AsyncStreamWriter(Sink& sink) : m_sink(sink){}
+
+	bool operator()(const PropertyT& property){
+		if(property.isNested()){
+			return property.visitChildren(PropertyT::Visitor::Reference(*this));
+		}
+		if(property.isNameOnly() || !property.isReadable()){
+			return true;
+		}
+		typename PropertyT::any_type value;
+		property.read(value);
+		if(auto entry = detail::HashProperty<PropertyT, TypeTable>(m_hash, property, value)){
+			for(;;){
+				detail::BinaryOutput output(m_chunk.data() + m_size, m_chunk.size() - m_size);
+				entry->encode(output, value);
+				if(!output.overflow()){
+					m_size += output.size();
+					break;
+				}
+				m_chunk.resize(std::max<std::size_t>(m_chunk.size() * 2, 256));
+			}
+		}
+		return true;
+	}
+	/**
+	 * @return awaitable of bool, which writes buffered chunk into sink.
+	 **/
+	auto flush(){
+		using inner_type = decltype(m_sink.write(m_chunk.data(), m_size));
+		struct FlushAwaiter{
+			bool await_ready(){return inner.await_ready();}
+			decltype(auto) await_suspend(std::coroutine_handle<> handle){return inner.await_suspend(handle);}
+			bool await_resume(){
+				bool written = inner.await_resume();
+				writer.m_size = 0;
+				return written;
+			}
+
+			AsyncStreamWriter& writer;
+			inner_type inner;
+		};
+		return FlushAwaiter{*this, m_sink.write(m_chunk.data(), m_size)};
+	}
+
+	/**
+	 * @return schema hash of visited properties, same as BinaryWriter stores in its header.
+	 **/
+	std::uint64_t schemaHash() const{return m_hash;}
+
+private: // members
+	Sink& m_sink;
+	std::vector<char> m_chunk;
+	std::size_t m_size = 0;
+	std::uint64_t m_hash = detail::hash_seed;
+};
+}
+#endif
@@ -0,0 +1,495 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#pragma once
+#include "property.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace nap{
+
+namespace detail{
+
+template<typename... Types>
+/**
+ * Value types which PropertyBuffer keeps copied in typed columns, they have to be default constructible and copy assignable.
+ **/
+struct BufferColumns{};
+
+using DefaultBufferColumns = BufferColumns<
+	bool, char, signed char, unsigned char, short, unsigned short, int, unsigned int,
+	long, unsigned long, long long, unsigned long long, float, double, std::string
+>;
+
+template<typename T, typename... Types>
+struct column_index : std::integral_constant<std::size_t, 0>{};
+template<typename T, typename First, typename... Types>
+/**
+ * Index of T within Types, or sizeof...(Types) when T is not one of them.
+ **/
+struct column_index<T, First, Types...> : std::integral_constant<std::size_t, std::is_same_v<T, First> ? 0 : 1 + column_index<T, Types...>::value>{};
+
+template<class Iterator>
+inline constexpr bool is_random_access_v = std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>;
+}
+
+template<class PropertyT, class Columns = detail::DefaultBufferColumns>
+class PropertyBuffer;
+
+template<class PropertyT, typename... Types>
+/**
+ * Reusable buffer holding values of whole property list, copied into contiguous typed column per type of Columns.
+ * Values of other types are kept as any_type produced by read (with DefaultInterface pointer to source variable, not its copy),
+ *  name only and other not readable properties take position but hold no value.
+ * 
+ * Layout (column and slot of each position) is made by first batch with one type lookup per property and kept,
+ *  so following batches over same shaped lists only check type of each value and copy it into existing slot.
+ * Batches over random access lists run one loop per column, each of them handling single type without any dispatch,
+ *  visitors (reader(), writer()) follow order of visiting.
+ * Since typed values are copies, buffer can also snapshot object and later restore it into the same object.
+ * 
+ * Usage:
+ *   PropertyBuffer<Property> buffer;
+ *   buffer.readAll(source.properties());   // or object.propertiesFunc(Property::Visitor::Reference(buffer.reader()))
+ *   *buffer.get<int>(2) = newValue;
+ *   const std::vector<float>& floats = buffer.column<float>();
+ *   buffer.writeAll(target.properties());
+ **/
+class PropertyBuffer<PropertyT, detail::BufferColumns<Types...>>{
+public: // type definitions
+	using any_type  = typename PropertyT::any_type;
+	using interface = typename PropertyT::interface;
+
+	/**
+	 * Visitor filling buffer, usable with objects which present properties via visitor.
+	 **/
+	class Reader{
+	public: // functions
+		explicit Reader(PropertyBuffer& buffer) : m_buffer(buffer){m_buffer.m_size = 0;}
+		bool operator()(const PropertyT& property){
+			m_buffer.readNext(property);
+			return true;
+		}
+	private: // members
+		PropertyBuffer& m_buffer;
+	};
+
+	/**
+	 * Visitor writing buffer back, properties are matched by position in visited list.
+	 **/
+	class Writer{
+	public: // functions
+		explicit Writer(PropertyBuffer& buffer) : m_buffer(buffer){}
+		/**
+		 * @return false when visited list is longer than buffer, otherwise true.
+		 **/
+		bool operator()(const PropertyT& property){
+			return m_buffer.writeAt(m_position++, property);
+		}
+	private: // members
+		PropertyBuffer& m_buffer;
+		std::size_t m_position = 0;
+	};
+
+public: // functions
+	PropertyBuffer() = default;
+	/**
+	 * @param capacity expected number of properties, reserved up front.
+	 **/
+	explicit PropertyBuffer(std::size_t capacity){reserve(capacity);}
+
+	void reserve(std::size_t capacity){
+		m_slots.reserve(capacity);
+	}
+
+	Reader reader(){return Reader(*this);}
+	Writer writer(){return Writer(*this);}
+
+	template<class PropertyArray>
+	/**
+	 * Reads all readable properties of container into buffer, replacing its previous content.
+	 * 
+	 * @return number of properties in buffer.
+	 **/
+	std::size_t readAll(const PropertyArray& properties){
+		return readRange(std::begin(properties), std::end(properties));
+	}
+	std::size_t readAll(std::initializer_list<PropertyT> ilProperties){
+		return readRange(ilProperties.begin(), ilProperties.end());
+	}
+
+	template<class PropertyArray>
+	/**
+	 * Writes buffer back into properties at the same positions, only positions which were read are written
+	 *  and only into writable properties, which have to be of the same types as the read ones.
+	 * 
+	 * @return false when container is longer than buffer, otherwise true.
+	 **/
+	bool writeAll(const PropertyArray& properties){
+		return writeRange(std::begin(properties), std::end(properties));
+	}
+	bool writeAll(std::initializer_list<PropertyT> ilProperties){
+		return writeRange(ilProperties.begin(), ilProperties.end());
+	}
+
+	/**
+	 * @return number of properties read by last batch.
+	 **/
+	std::size_t size() const{return m_size;}
+	bool empty() const{return (m_size == 0);}
+	/**
+	 * @return true when position holds value of readable property.
+	 **/
+	bool isRead(std::size_t position) const{return (position < m_size) && (m_slots[position].column != EmptyColumn);}
+
+	/**
+	 * @return value at position as any_type pointing into the buffer (or kept read value for types outside of columns),
+	 *  empty any_type when position was not read.
+	 **/
+	any_type value(std::size_t position) const{
+		if(!isRead(position)){
+			return any_type();
+		}
+		const Slot& slot = m_slots[position];
+		if(slot.column == OtherColumn){
+			return m_others[slot.index];
+		}
+		return Values[slot.column](*this, slot.index);
+	}
+	template<typename T>
+	/**
+	 * @return pointer to copy of value at position, or nullptr when it is not value of type T.
+	 **/
+	T* get(std::size_t position){
+		constexpr std::size_t column = ColumnOf<T>();
+		if(position >= m_size || m_slots[position].column != column){
+			return nullptr;
+		}
+		return &std::get<column>(m_columns)[m_slots[position].index];
+	}
+	template<typename T>
+	const T* get(std::size_t position) const{
+		return const_cast<PropertyBuffer*>(this)->template get<T>(position);
+	}
+	template<typename T>
+	/**
+	 * @return contiguous column of all values of type T, in order of their positions (see positions<T>()).
+	 *  After visiting list shorter than earlier ones by reader, column can still hold values of positions past size().
+	 **/
+	const std::vector<T>& column() const{
+		return std::get<ColumnOf<T>()>(m_columns);
+	}
+	template<typename T>
+	/**
+	 * @return ascending positions of values in column of type T.
+	 **/
+	const std::vector<std::uint32_t>& positions() const{
+		return m_positions[ColumnOf<T>()];
+	}
+
+	/**
+	 * Forgets content and layout without releasing memory of columns.
+	 **/
+	void clear(){
+		m_size = 0;
+		truncate(0);
+	}
+
+private: // type definitions
+	static constexpr std::uint32_t OtherColumn = sizeof...(Types);
+	static constexpr std::uint32_t EmptyColumn = sizeof...(Types) + 1;
+
+	struct Slot{
+		std::uint32_t column; // index of Types, OtherColumn or EmptyColumn
+		std::uint32_t index;  // index within column
+	};
+
+	using StoreFunc  = bool (*)(PropertyBuffer& buffer, std::uint32_t index, any_type& value);
+	using AppendFunc = void (*)(PropertyBuffer& buffer, any_type& value);
+	using ValueFunc  = any_type (*)(const PropertyBuffer& buffer, std::uint32_t index);
+
+private: // static functions
+	template<typename T>
+	static constexpr std::size_t ColumnOf(){
+		constexpr std::size_t column = detail::column_index<T, Types...>::value;
+		static_assert(column < sizeof...(Types), "type is not one of buffer columns");
+		return column;
+	}
+	template<std::size_t Column>
+	using column_type = std::tuple_element_t<Column, std::tuple<Types...>>;
+
+	// values of columns which interface cannot hold never reach them, so their functions are left empty
+	template<typename T>
+	static bool Store(PropertyBuffer& buffer, std::uint32_t index, any_type& value){
+		constexpr std::size_t Column = detail::column_index<T, Types...>::value;
+		if constexpr(detail::interface_supports_v<interface, T>){
+			if(interface::template is_any<T>(value)){
+				std::get<Column>(buffer.m_columns)[index] = interface::template cast_any<T>(value);
+				return true;
+			}
+			if(interface::template is_any<T&>(value)){
+				std::get<Column>(buffer.m_columns)[index] = interface::template cast_any<T&>(value);
+				return true;
+			}
+		}
+		return false;
+	}
+	template<typename T>
+	static void Append(PropertyBuffer& buffer, any_type& value){
+		constexpr std::size_t Column = detail::column_index<T, Types...>::value;
+		std::get<Column>(buffer.m_columns).emplace_back();
+		Store<T>(buffer, static_cast<std::uint32_t>(std::get<Column>(buffer.m_columns).size() - 1), value);
+	}
+	template<typename T>
+	static any_type Value(const PropertyBuffer& buffer, std::uint32_t index){
+		constexpr std::size_t Column = detail::column_index<T, Types...>::value;
+		if constexpr(detail::interface_supports_v<interface, T>){
+			return interface::template make_any<T>(std::get<Column>(buffer.m_columns)[index]);
+		}
+		else{
+			return any_type();
+		}
+	}
+
+	/**
+	 * @return column of type stored in value, or OtherColumn when it is not one of Types.
+	 **/
+	static std::uint32_t FindColumn(const any_type& value){
+		// built once per property template, so reading does not allocate
+		static const std::unordered_map<typename interface::type_key, std::uint32_t> table = MakeTable(std::index_sequence_for<Types...>{});
+		auto itColumn = table.find(interface::key_of(value));
+		return (itColumn != table.end()) ? itColumn->second : OtherColumn;
+	}
+	template<std::size_t... Columns>
+	static std::unordered_map<typename interface::type_key, std::uint32_t> MakeTable(std::index_sequence<Columns...>){
+		std::unordered_map<typename interface::type_key, std::uint32_t> table;
+		(AddColumn<Columns>(table), ...);
+		return table;
+	}
+	template<std::size_t Column>
+	static void AddColumn(std::unordered_map<typename interface::type_key, std::uint32_t>& table){
+		using T = column_type<Column>;
+		if constexpr(detail::interface_supports_v<interface, T>){
+			table.emplace(interface::template key_of<T>(), static_cast<std::uint32_t>(Column));
+			table.emplace(interface::template key_of<T&>(), static_cast<std::uint32_t>(Column));
+		}
+	}
+
+private: // functions
+	template<class Iterator>
+	std::size_t readRange(Iterator first, Iterator last){
+		m_size = 0;
+		if constexpr(detail::is_random_access_v<Iterator>){
+			if(static_cast<std::size_t>(last - first) == m_slots.size() && readColumns(first, std::index_sequence_for<Types...>{})){
+				m_size = m_slots.size();
+				return m_size;
+			}
+		}
+		// first batch, or list of other shape
+		for(; first != last; ++first){
+			readNext(*first);
+		}
+		truncate(m_size);
+		return m_size;
+	}
+	template<class Iterator, std::size_t... Columns>
+	bool readColumns(Iterator first, std::index_sequence<Columns...>){
+		return (readColumn<Columns>(first) && ...) && readOthers(first) && checkEmpty(first);
+	}
+	template<std::size_t Column, class Iterator>
+	bool readColumn(Iterator first){
+		const std::vector<std::uint32_t>& positions = m_positions[Column];
+		for(std::size_t i = 0; i < positions.size(); ++i){
+			const PropertyT& property = first[positions[i]];
+			if(!property.isReadable()){
+				return false;
+			}
+			property.read(m_value);
+			if(!Store<column_type<Column>>(*this, static_cast<std::uint32_t>(i), m_value)){
+				return false;
+			}
+		}
+		return true;
+	}
+	template<class Iterator>
+	bool readOthers(Iterator first){
+		const std::vector<std::uint32_t>& positions = m_positions[OtherColumn];
+		for(std::size_t i = 0; i < positions.size(); ++i){
+			const PropertyT& property = first[positions[i]];
+			if(!property.isReadable()){
+				return false;
+			}
+			property.read(m_others[i]);
+		}
+		return true;
+	}
+	template<class Iterator>
+	bool checkEmpty(Iterator first) const{
+		for(std::uint32_t position : m_positions[EmptyColumn]){
+			if(first[position].isReadable()){
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<class Iterator>
+	bool writeRange(Iterator first, Iterator last){
+		if constexpr(detail::is_random_access_v<Iterator>){
+			if(static_cast<std::size_t>(last - first) == m_size && m_size == m_slots.size()){
+				writeColumns(first, std::index_sequence_for<Types...>{});
+				return true;
+			}
+		}
+		for(std::size_t position = 0; first != last; ++first){
+			if(writeAt(position++, *first) == false){
+				return false;
+			}
+		}
+		return true;
+	}
+	template<class Iterator, std::size_t... Columns>
+	void writeColumns(Iterator first, std::index_sequence<Columns...>){
+		(writeColumn<Columns>(first), ...);
+		const std::vector<std::uint32_t>& positions = m_positions[OtherColumn];
+		for(std::size_t i = 0; i < positions.size(); ++i){
+			const PropertyT& property = first[positions[i]];
+			if(property.isWritable()){
+				property.write(m_others[i]);
+			}
+		}
+	}
+	template<std::size_t Column, class Iterator>
+	void writeColumn(Iterator first){
+		const std::vector<std::uint32_t>& positions = m_positions[Column];
+		for(std::size_t i = 0; i < positions.size(); ++i){
+			const PropertyT& property = first[positions[i]];
+			if(property.isWritable()){
+				m_value = Value<column_type<Column>>(*this, static_cast<std::uint32_t>(i));
+				property.write(m_value);
+			}
+		}
+	}
+
+	void readNext(const PropertyT& property){
+		const std::size_t position = m_size++;
+		if(position < m_slots.size()){
+			if(readSlot(m_slots[position], property)){
+				return;
+			}
+			// different type than in layout, layout is made again from this position
+			truncate(position);
+		}
+		appendSlot(property);
+	}
+	bool readSlot(const Slot& slot, const PropertyT& property){
+		if(slot.column == EmptyColumn){
+			return !property.isReadable();
+		}
+		if(!property.isReadable()){
+			return false;
+		}
+		if(slot.column == OtherColumn){
+			property.read(m_others[slot.index]);
+			return true;
+		}
+		property.read(m_value);
+		return Stores[slot.column](*this, slot.index, m_value);
+	}
+	void appendSlot(const PropertyT& property){
+		std::uint32_t column = EmptyColumn;
+		if(property.isReadable()){
+			property.read(m_value);
+			column = FindColumn(m_value);
+			if(column == OtherColumn){
+				m_others.push_back(m_value);
+			}
+			else{
+				Appends[column](*this, m_value);
+			}
+		}
+		std::vector<std::uint32_t>& positions = m_positions[column];
+		m_slots.push_back(Slot{column, static_cast<std::uint32_t>(positions.size())});
+		positions.push_back(static_cast<std::uint32_t>(m_slots.size() - 1));
+	}
+	bool writeAt(std::size_t position, const PropertyT& property){
+		if(position >= m_size){
+			return false;
+		}
+		const Slot& slot = m_slots[position];
+		if(slot.column == EmptyColumn || !property.isWritable()){
+			return true;
+		}
+		if(slot.column == OtherColumn){
+			property.write(m_others[slot.index]);
+			return true;
+		}
+		m_value = Values[slot.column](*this, slot.index);
+		property.write(m_value);
+		return true;
+	}
+	/**
+	 * Drops layout of positions from position on, together with their values.
+	 **/
+	void truncate(std::size_t position){
+		if(position >= m_slots.size()){
+			return;
+		}
+		m_slots.resize(position);
+		for(std::vector<std::uint32_t>& positions : m_positions){
+			while(!positions.empty() && positions.back() >= position){
+				positions.pop_back();
+			}
+		}
+		truncateColumns(std::index_sequence_for<Types...>{});
+		m_others.resize(m_positions[OtherColumn].size());
+	}
+	template<std::size_t... Columns>
+	void truncateColumns(std::index_sequence<Columns...>){
+		(std::get<Columns>(m_columns).resize(m_positions[Columns].size()), ...);
+	}
+
+private: // static members
+	// indexed by column, types listed twice use their first column
+	static constexpr std::array<StoreFunc, sizeof...(Types)> Stores{&Store<Types>...};
+	static constexpr std::array<AppendFunc, sizeof...(Types)> Appends{&Append<Types>...};
+	static constexpr std::array<ValueFunc, sizeof...(Types)> Values{&Value<Types>...};
+
+private: // members
+	std::vector<Slot> m_slots;
+	std::size_t m_size = 0;
+	std::tuple<std::vector<Types>...> m_columns;
+	std::array<std::vector<std::uint32_t>, sizeof...(Types) + 2> m_positions; // of each column, OtherColumn and EmptyColumn
+	std::vector<any_type> m_others;
+	any_type m_value; // reused for values of typed columns
+};
+}
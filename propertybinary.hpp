@@ -0,0 +1,513 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#pragma once
+#include "property.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace nap{
+
+namespace detail{
+
+/**
+ * Updates 64-bit FNV-1a hash with given bytes.
+ **/
+inline std::uint64_t HashBytes(std::uint64_t hash, const void* data, std::size_t size){
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for(std::size_t i = 0; i < size; ++i){
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+inline constexpr std::uint64_t hash_seed = 0xcbf29ce484222325ull;
+
+/**
+ * Writes packed little-endian values into caller provided buffer.
+ * After first write which would not fit, output is marked as overflown and ignores further writes.
+ **/
+class BinaryOutput{
+public: // functions
+	BinaryOutput(char* data, std::size_t capacity) : m_data(data), m_capacity(capacity){}
+
+	template<typename T>
+	void putFixed(T value){
+		static_assert(std::is_integral_v<T>, "putFixed expects integral type");
+		using unsigned_type = std::make_unsigned_t<T>;
+		unsigned_type bits = static_cast<unsigned_type>(value);
+		char bytes[sizeof(T)];
+		for(std::size_t i = 0; i < sizeof(T); ++i){
+			bytes[i] = static_cast<char>((bits >> (8 * i)) & 0xff);
+		}
+		put(bytes, sizeof(T));
+	}
+	void putVarint(std::uint64_t value){
+		char bytes[10];
+		std::size_t size = 0;
+		do{
+			unsigned char byte = value & 0x7f;
+			value >>= 7;
+			bytes[size++] = static_cast<char>(value ? (byte | 0x80) : byte);
+		}while(value);
+		put(bytes, size);
+	}
+	void put(const void* bytes, std::size_t size){
+		if(m_overflow || (m_capacity - m_size) < size){
+			m_overflow = true;
+			return;
+		}
+		std::memcpy(m_data + m_size, bytes, size);
+		m_size += size;
+	}
+	/**
+	 * Overwrites already written bytes at offset, used for patching headers.
+	 **/
+	void patch(std::size_t offset, const void* bytes, std::size_t size){
+		if(offset + size <= m_size){
+			std::memcpy(m_data + offset, bytes, size);
+		}
+	}
+
+	/**
+	 * Drops bytes written after size, used for discarding entries which turned out to be empty.
+	 **/
+	void truncate(std::size_t size){
+		if(size < m_size){
+			m_size = size;
+		}
+	}
+
+	std::size_t size() const{return m_size;}
+	bool overflow() const{return m_overflow;}
+
+private: // members
+	char* m_data;
+	std::size_t m_capacity;
+	std::size_t m_size = 0;
+	bool m_overflow = false;
+};
+
+/**
+ * Reads packed little-endian values from contiguous buffer, without any allocation.
+ * After first read past the end, input is marked as underflown and all further reads return zeros.
+ **/
+class BinaryInput{
+public: // functions
+	BinaryInput(const char* data, std::size_t size) : m_data(data), m_size(size){}
+
+	template<typename T>
+	T getFixed(){
+		static_assert(std::is_integral_v<T>, "getFixed expects integral type");
+		using unsigned_type = std::make_unsigned_t<T>;
+		const char* bytes = get(sizeof(T));
+		if(bytes == nullptr){
+			return T{};
+		}
+		unsigned_type bits = 0;
+		for(std::size_t i = 0; i < sizeof(T); ++i){
+			bits |= static_cast<unsigned_type>(static_cast<unsigned char>(bytes[i])) << (8 * i);
+		}
+		return static_cast<T>(bits);
+	}
+	std::uint64_t getVarint(){
+		std::uint64_t value = 0;
+		for(unsigned shift = 0; shift < 64; shift += 7){
+			const char* byte = get(1);
+			if(byte == nullptr){
+				return 0;
+			}
+			value |= static_cast<std::uint64_t>(*byte & 0x7f) << shift;
+			if((*byte & 0x80) == 0){
+				return value;
+			}
+		}
+		m_underflow = true;
+		return 0;
+	}
+	/**
+	 * @return pointer to next size bytes, or nullptr when there is not enough bytes left.
+	 **/
+	const char* get(std::size_t size){
+		if(m_underflow || (m_size - m_position) < size){
+			m_underflow = true;
+			return nullptr;
+		}
+		const char* bytes = m_data + m_position;
+		m_position += size;
+		return bytes;
+	}
+
+	std::size_t position() const{return m_position;}
+	bool underflow() const{return m_underflow;}
+
+private: // members
+	const char* m_data;
+	std::size_t m_size;
+	std::size_t m_position = 0;
+	bool m_underflow = false;
+};
+
+template<typename T>
+/**
+ * Encoding of single value type, integers are stored with fixed width of their type
+ *  (long is always stored as 8 bytes), floating points as their IEEE-754 bits
+ *  and strings as varint length followed by bytes.
+ **/
+struct BinaryCodec{
+	static void Encode(BinaryOutput& output, const T& value){
+		if constexpr(std::is_same_v<T, bool>){
+			output.putFixed<std::uint8_t>(value ? 1 : 0);
+		}
+		else if constexpr(std::is_same_v<T, long> || std::is_same_v<T, unsigned long>){
+			output.putFixed<std::int64_t>(static_cast<std::int64_t>(value));
+		}
+		else if constexpr(std::is_integral_v<T>){
+			output.putFixed<T>(value);
+		}
+		else if constexpr(std::is_same_v<T, float>){
+			std::uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			output.putFixed<std::uint32_t>(bits);
+		}
+		else if constexpr(std::is_same_v<T, double>){
+			std::uint64_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			output.putFixed<std::uint64_t>(bits);
+		}
+		else{
+			std::string_view string(value);
+			output.putVarint(string.size());
+			output.put(string.data(), string.size());
+		}
+	}
+	/**
+	 * Decodes value, strings are returned as std::string_view pointing into input.
+	 **/
+	static auto Decode(BinaryInput& input){
+		if constexpr(std::is_same_v<T, bool>){
+			return input.getFixed<std::uint8_t>() != 0;
+		}
+		else if constexpr(std::is_same_v<T, long> || std::is_same_v<T, unsigned long>){
+			return static_cast<T>(input.getFixed<std::int64_t>());
+		}
+		else if constexpr(std::is_integral_v<T>){
+			return input.getFixed<T>();
+		}
+		else if constexpr(std::is_same_v<T, float>){
+			std::uint32_t bits = input.getFixed<std::uint32_t>();
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+		else if constexpr(std::is_same_v<T, double>){
+			std::uint64_t bits = input.getFixed<std::uint64_t>();
+			double value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+		else{
+			std::size_t size = static_cast<std::size_t>(input.getVarint());
+			const char* bytes = input.get(size);
+			return (bytes == nullptr) ? std::string_view() : std::string_view(bytes, size);
+		}
+	}
+};
+
+template<typename T, typename = void>
+struct is_equality_comparable : std::false_type{};
+template<typename T>
+struct is_equality_comparable<T, std::void_t<decltype(std::declval<const T&>() == std::declval<const T&>())>> : std::true_type{};
+
+template<typename T>
+/**
+ * Compares values by their bytes when type is trivially copyable and bytes fully describe the value
+ *  (floating points are compared bitwise too, so unchanged NaN is equal), by operator== otherwise.
+ **/
+bool EqualValues(const T& left, const T& right){
+	if constexpr(std::is_trivially_copyable_v<T> && 
+		(std::has_unique_object_representations_v<T> || std::is_floating_point_v<T> || !is_equality_comparable<T>::value)){
+		return std::memcmp(&left, &right, sizeof(T)) == 0;
+	}
+	else{
+		return left == right;
+	}
+}
+
+template<class PropertyT, typename... Types>
+/**
+ * Table of binary codecs for Types, keyed by interface type key.
+ * Tag of type is its position in Types + 1, tag 0 is used for unsupported types.
+ **/
+class BinaryTypeTable{
+public: // type definitions
+	using any_type  = typename PropertyT::any_type;
+	using interface = typename PropertyT::interface;
+
+	struct Entry{
+		std::uint8_t tag;
+		void (*encode)(BinaryOutput& output, const any_type& value);
+		bool (*decode)(BinaryInput& input, const PropertyT& property, std::string& scratch);
+		bool (*equal)(const any_type& left, const any_type& right); // both values have type of entry
+	};
+
+public: // static functions
+	/**
+	 * @return codec entry of type stored in value, or nullptr when type is not supported.
+	 **/
+	static const Entry* Find(const any_type& value){
+		// built once per property template, so visiting does not allocate
+		static const std::unordered_map<typename interface::type_key, Entry> table = MakeTable(std::index_sequence_for<Types...>{});
+		auto itEntry = table.find(interface::key_of(value));
+		return (itEntry != table.end()) ? &itEntry->second : nullptr;
+	}
+
+private: // static functions
+	template<std::size_t... Indices>
+	static std::unordered_map<typename interface::type_key, Entry> MakeTable(std::index_sequence<Indices...>){
+		std::unordered_map<typename interface::type_key, Entry> table;
+		(AddEntry<Types>(table, Indices + 1), ...);
+		return table;
+	}
+	template<typename T>
+	static void AddEntry(std::unordered_map<typename interface::type_key, Entry>& table, std::size_t tag){
+		// types which interface cannot hold keep their tag, so archives stay compatible between interfaces
+		if constexpr(interface_supports_v<interface, T>){
+			table.emplace(interface::template key_of<T>(), Entry{static_cast<std::uint8_t>(tag), &Encode<T>, &Decode<T>, &Equal<T>});
+		}
+	}
+
+	template<typename T>
+	static void Encode(BinaryOutput& output, const any_type& value){
+		BinaryCodec<T>::Encode(output, interface::template cast_any<T>(value));
+	}
+
+	template<typename T>
+	static bool Equal(const any_type& left, const any_type& right){
+		return EqualValues<T>(interface::template cast_any<T>(left), interface::template cast_any<T>(right));
+	}
+
+	template<typename T>
+	static bool Decode(BinaryInput& input, const PropertyT& property, std::string& scratch){
+		auto decoded = BinaryCodec<T>::Decode(input);
+		if(input.underflow()){
+			return false;
+		}
+		if(!property.isWritable()){
+			return true;
+		}
+		any_type value;
+		if constexpr(std::is_same_v<T, std::string>){
+			// reuse capacity of scratch and of the member, instead of allocating new string per field
+			scratch.assign(decoded);
+			value = interface::template make_any<const std::string&>(scratch);
+		}
+		else{
+			value = interface::template make_any<T&>(decoded);
+		}
+		property.write(value);
+		return true;
+	}
+};
+
+template<class PropertyT>
+using DefaultBinaryTypes = BinaryTypeTable<PropertyT,
+	bool, char, signed char, unsigned char, short, unsigned short, int, unsigned int,
+	long, unsigned long, long long, unsigned long long, float, double, std::string, std::string_view
+>;
+
+template<class PropertyT, class TypeTable>
+/**
+ * Updates schema hash with property name and tag of its type.
+ * 
+ * @return codec entry of property type, or nullptr for unsupported types.
+ **/
+const typename TypeTable::Entry* HashProperty(std::uint64_t& hash, const PropertyT& property, const typename PropertyT::any_type& value){
+	std::string_view name(property.name());
+	const typename TypeTable::Entry* entry = TypeTable::Find(value);
+	std::uint8_t tag = (entry != nullptr) ? entry->tag : 0;
+	hash = HashBytes(hash, name.data(), name.size());
+	hash = HashBytes(hash, &tag, sizeof(tag));
+	return entry;
+}
+}
+
+template<class PropertyT, class TypeTable = detail::DefaultBinaryTypes<PropertyT>>
+/**
+ * Visitor computing schema hash of visited properties, out of their names and types.
+ * Used for checking that binary archive matches properties before reading from it.
+ * 
+ * Name only properties and properties which are not readable are skipped, nested properties are descended into.
+ **/
+class BinarySchemaHash{
+public: // functions
+	bool operator()(const PropertyT& property){
+		if(property.isNested()){
+			return property.visitChildren(PropertyT::Visitor::Reference(*this));
+		}
+		if(property.isNameOnly() || !property.isReadable()){
+			return true;
+		}
+		typename PropertyT::any_type value;
+		property.read(value);
+		detail::HashProperty<PropertyT, TypeTable>(m_hash, property, value);
+		return true;
+	}
+
+	std::uint64_t hash() const{return m_hash;}
+
+private: // members
+	std::uint64_t m_hash = detail::hash_seed;
+};
+
+template<class PropertyT, class TypeTable = detail::DefaultBinaryTypes<PropertyT>>
+/**
+ * Visitor writing properties into caller provided contiguous buffer.
+ * 
+ * Format is 8 byte little-endian schema hash followed by packed little-endian values
+ *  in order of visiting, strings are prefixed by varint length.
+ * Name only properties, properties which are not readable and properties of unsupported types
+ *  do not store any value (unsupported types are still part of schema hash).
+ * Children of nested properties are stored in place of their parent.
+ * 
+ * Usage:
+ *   BinaryWriter<Property> writer(buffer, sizeof(buffer));
+ *   object.propertiesFunc(Property::Visitor::Reference(writer));
+ *   if(writer.finish()) send(buffer, writer.size());
+ **/
+class BinaryWriter{
+public: // functions
+	BinaryWriter(char* data, std::size_t capacity) : m_output(data, capacity){
+		m_output.putFixed<std::uint64_t>(0);
+	}
+
+	/**
+	 * Writes value of property into buffer.
+	 * 
+	 * @return false when buffer is too small, otherwise true.
+	 **/
+	bool operator()(const PropertyT& property){
+		if(property.isNested()){
+			return property.visitChildren(PropertyT::Visitor::Reference(*this));
+		}
+		if(property.isNameOnly() || !property.isReadable()){
+			return true;
+		}
+		typename PropertyT::any_type value;
+		property.read(value);
+		if(auto entry = detail::HashProperty<PropertyT, TypeTable>(m_hash, property, value)){
+			[[maybe_unused]] std::size_t start = m_output.size();
+			entry->encode(m_output, value);
+			NAP_INSTRUMENT_BYTES(Read, property.name(), m_output.size() - start);
+		}
+		return !m_output.overflow();
+	}
+	/**
+	 * Stores schema hash into header, has to be called after all properties were visited.
+	 * 
+	 * @return false when buffer was too small, otherwise true.
+	 **/
+	bool finish(){
+		char header[sizeof(std::uint64_t)];
+		detail::BinaryOutput headerOutput(header, sizeof(header));
+		headerOutput.putFixed<std::uint64_t>(m_hash);
+		m_output.patch(0, header, sizeof(header));
+		return !m_output.overflow();
+	}
+
+	/**
+	 * @return number of bytes written into buffer.
+	 **/
+	std::size_t size() const{return m_output.size();}
+	std::uint64_t schemaHash() const{return m_hash;}
+
+private: // members
+	detail::BinaryOutput m_output;
+	std::uint64_t m_hash = detail::hash_seed;
+};
+
+template<class PropertyT, class TypeTable = detail::DefaultBinaryTypes<PropertyT>>
+/**
+ * Visitor reading properties from buffer written by BinaryWriter, writing decoded values into properties.
+ * Numbers are written by move from local value, strings are copied through one reused scratch string,
+ *  so reading does not allocate per field.
+ * 
+ * Properties which are not writable still consume their value.
+ * To validate archive before writing into any property, compare schemaHash() with BinarySchemaHash of the object.
+ **/
+class BinaryReader{
+public: // functions
+	BinaryReader(const char* data, std::size_t size) : m_input(data, size){
+		m_storedHash = m_input.getFixed<std::uint64_t>();
+	}
+
+	/**
+	 * Reads value of property from buffer and writes it into property.
+	 * 
+	 * @return false when buffer has not enough data, otherwise true.
+	 **/
+	bool operator()(const PropertyT& property){
+		if(property.isNested()){
+			return property.visitChildren(PropertyT::Visitor::Reference(*this));
+		}
+		if(property.isNameOnly() || !property.isReadable()){
+			return true;
+		}
+		typename PropertyT::any_type value;
+		property.read(value);
+		if(auto entry = detail::HashProperty<PropertyT, TypeTable>(m_hash, property, value)){
+			[[maybe_unused]] std::size_t start = m_input.position();
+			bool decoded = entry->decode(m_input, property, m_scratch);
+			NAP_INSTRUMENT_BYTES(Write, property.name(), m_input.position() - start);
+			return decoded;
+		}
+		return !m_input.underflow();
+	}
+	/**
+	 * @return true when all values were read and schema hash of visited properties matches the archive.
+	 **/
+	bool finish() const{
+		return !m_input.underflow() && (m_hash == m_storedHash);
+	}
+
+	/**
+	 * @return schema hash stored in archive header.
+	 **/
+	std::uint64_t schemaHash() const{return m_storedHash;}
+	/**
+	 * @return number of bytes consumed from buffer.
+	 **/
+	std::size_t position() const{return m_input.position();}
+
+private: // members
+	detail::BinaryInput m_input;
+	std::uint64_t m_storedHash = 0;
+	std::uint64_t m_hash = detail::hash_seed;
+	std::string m_scratch;
+};
+}
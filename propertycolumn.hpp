@@ -0,0 +1,191 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#pragma once
+#include "property.hpp"
+#include "propertyschema.hpp"
+
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace nap{
+
+template<class T, class ObjectIt, class Name>
+/**
+ * Fills column with value of single schema field of each object in range,
+ *  field is looked up once and then copied directly via member pointer, so the loop can be vectorized.
+ * 
+ * @param name field name or precomputed NameHash.
+ * @param column output with space for std::distance(first, last) values.
+ * 
+ * @return false when schema has no such field or its type is not exactly T, otherwise true.
+ **/
+bool ExtractColumn(ObjectIt first, ObjectIt last, Name name, T* column){
+	using Object = std::remove_const_t<std::remove_reference_t<decltype(*first)>>;
+	constexpr const auto& schema = schema_of<Object>;
+	T Object::* member = schema.template memberOf<T, Object>(schema.indexOf(name));
+	if(member == nullptr){
+		return false;
+	}
+	for(; first != last; ++first, ++column){
+		*column = (*first).*member;
+	}
+	return true;
+}
+
+template<class T, class Objects, class Name>
+/**
+ * Fills column with value of single schema field of each object in container, column is resized to its size.
+ * 
+ * @see ExtractColumn
+ **/
+bool ExtractColumn(const Objects& objects, Name name, std::vector<T>& column){
+	column.resize(std::size(objects));
+	return ExtractColumn(std::begin(objects), std::end(objects), name, column.data());
+}
+
+namespace detail{
+
+template<class PropertyT, class T, class Object>
+/**
+ * Visitor locating named property, recording its position in list and offset of its variable within object.
+ **/
+struct ColumnLocator{
+	bool operator()(const PropertyT& property){
+		if(property.name() != name){
+			++position;
+			return true;
+		}
+		found = property.isReadable();
+		if(found && property.type() != nullptr){
+			// type is known from metadata, so nothing has to be read
+			found = property.template isType<T>();
+			offset = property.offsetIn(object);
+		}
+		else if(found){
+			typename PropertyT::any_type value;
+			property.read(value);
+			found = PropertyT::interface::template is_any<T>(value);
+		}
+		return false;
+	}
+
+	typename PropertyT::string_type name;
+	const Object& object;
+	std::size_t position = 0;
+	std::size_t offset = PropertyT::npos;
+	bool found = false;
+};
+
+template<class PropertyT, class T>
+/**
+ * Visitor reading property at known position of list into single column slot.
+ **/
+struct ColumnReader{
+	bool operator()(const PropertyT& property){
+		if(current++ != position){
+			return true;
+		}
+		property.read(value);
+		if(PropertyT::interface::template is_any<T>(value)){
+			*output = PropertyT::interface::template cast_any<T>(value);
+			valid = true;
+		}
+		return false;
+	}
+
+	typename PropertyT::any_type value;
+	std::size_t position = 0;
+	std::size_t current = 0;
+	T* output = nullptr;
+	bool valid = false;
+};
+}
+
+template<class PropertyT, class T, class ObjectIt, class PresentFunc>
+/**
+ * Fills column with value of single named property of each object in range, using property lists objects already present.
+ * Property is located by visiting first object. When it was constructed from member of the object itself
+ *  (no custom read functor), member offset known from property metadata is used to copy values of all objects directly without visiting them,
+ *  otherwise each object is visited up to the property position.
+ * 
+ * @param name property name.
+ * @param present functor with signature void(Object& object, const typename PropertyT::Visitor& visitor),
+ *  which presents properties of object e.g. [](Point& point, const auto& visitor){point.presentProperties(visitor);}.
+ * @param column output with space for std::distance(first, last) values.
+ * 
+ * @return false when property was not found, is not readable or its type is not T, otherwise true.
+ * 
+ * @note Objects in range have to be of the same type and present the same property list.
+ **/
+bool ExtractPropertyColumn(ObjectIt first, ObjectIt last, typename PropertyT::string_type name, const PresentFunc& present, T* column){
+	if(first == last){
+		return true;
+	}
+	using Visitor = typename PropertyT::Visitor;
+
+	using Object = std::remove_reference_t<decltype(*first)>;
+	detail::ColumnLocator<PropertyT, T, Object> locator{name, *first};
+	present(*first, Visitor::Reference(locator));
+	if(!locator.found){
+		return false;
+	}
+
+	if constexpr(std::is_trivially_copyable_v<T>){
+		if(locator.offset != PropertyT::npos){
+			const std::size_t offset = locator.offset;
+			for(; first != last; ++first, ++column){
+				const char* base = reinterpret_cast<const char*>(std::addressof(*first));
+				std::memcpy(column, base + offset, sizeof(T));
+			}
+			return true;
+		}
+	}
+
+	detail::ColumnReader<PropertyT, T> reader;
+	reader.position = locator.position;
+	for(; first != last; ++first, ++column){
+		reader.current = 0;
+		reader.output = column;
+		reader.valid = false;
+		present(*first, Visitor::Reference(reader));
+		if(!reader.valid){
+			return false;
+		}
+	}
+	return true;
+}
+
+template<class PropertyT, class T, class Objects, class PresentFunc>
+/**
+ * Fills column with value of single named property of each object in container, column is resized to its size.
+ * 
+ * @see ExtractPropertyColumn
+ **/
+bool ExtractPropertyColumn(Objects& objects, typename PropertyT::string_type name, const PresentFunc& present, std::vector<T>& column){
+	column.resize(std::size(objects));
+	return ExtractPropertyColumn<PropertyT>(std::begin(objects), std::end(objects), name, present, column.data());
+}
+}
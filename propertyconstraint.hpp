@@ -0,0 +1,288 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#pragma once
+#include "propertyschema.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace nap{
+
+namespace detail{
+template<typename T>
+using constraint_value_t = std::conditional_t<std::is_convertible_v<T, const char*>, std::string_view, T>;
+}
+
+/**
+ * Constraints attached to schema fields, kept in own namespace so their short names do not clash with user types.
+ **/
+namespace constraint{
+
+template<typename T>
+/**
+ * Value has to be within [min, max], NaN is never valid.
+ **/
+struct Range{
+	static constexpr ConstraintKind kind = ConstraintKind::Range;
+
+	constexpr Range(T minimum, T maximum) : min(minimum), max(maximum){}
+
+	template<typename Value>
+	constexpr bool operator()(const Value& value) const{
+		return (value >= min) && (value <= max);
+	}
+
+	T min;
+	T max;
+};
+
+template<typename T, std::size_t Size>
+/**
+ * Value has to be equal to one of listed values.
+ * String literals are kept as std::string_view, so they can be compared with std::string members.
+ **/
+struct OneOf{
+	static constexpr ConstraintKind kind = ConstraintKind::OneOf;
+
+	template<typename... Values>
+	constexpr OneOf(Values... listed) : values{T(listed)...}{}
+
+	template<typename Value>
+	constexpr bool operator()(const Value& value) const{
+		for(const T& listed : values){
+			if(value == listed){
+				return true;
+			}
+		}
+		return false;
+	}
+
+	std::array<T, Size> values;
+};
+
+template<typename T, typename... Rest>
+OneOf(T, Rest...) -> OneOf<detail::constraint_value_t<T>, 1 + sizeof...(Rest)>;
+
+/**
+ * Size of string or container has to be within [min, max].
+ **/
+struct Length{
+	static constexpr ConstraintKind kind = ConstraintKind::Length;
+
+	constexpr Length(std::size_t minimum, std::size_t maximum) : min(minimum), max(maximum){}
+
+	template<typename Value>
+	constexpr bool operator()(const Value& value) const{
+		return (value.size() >= min) && (value.size() <= max);
+	}
+
+	std::size_t min;
+	std::size_t max;
+};
+
+template<typename T>
+/**
+ * Value has to satisfy custom predicate, given as function pointer so it can be part of constexpr schema.
+ **/
+struct Predicate{
+	static constexpr ConstraintKind kind = ConstraintKind::Predicate;
+
+	constexpr Predicate(bool (*function)(const T&)) : predicate(function){}
+
+	constexpr bool operator()(const T& value) const{
+		return predicate(value);
+	}
+
+	bool (*predicate)(const T&);
+};
+}
+
+/**
+ * Violated constraint found by ValidateObjects.
+ **/
+struct Violation{
+	std::size_t object; // position of object in validated range
+	std::size_t field;  // index of field in schema
+};
+
+namespace detail{
+
+template<class Field>
+inline constexpr bool is_constrained_v = !std::is_same_v<typename Field::constraint_type, Unconstrained>;
+
+template<class Field>
+/**
+ * Range constraints of arithmetic members are checked over chunks of objects, without branches.
+ **/
+inline constexpr bool is_range_column_v = (Field::constraint_type::kind == ConstraintKind::Range) && std::is_arithmetic_v<typename Field::value_type>;
+
+template<class Object, std::size_t Index>
+/**
+ * @return 1 when range constraint of arithmetic field is violated, otherwise 0, without branches.
+ **/
+std::uint8_t RangeViolated(const Object& object){
+	constexpr const auto& field = schema_of<Object>.template field<Index>();
+	using field_type = std::remove_const_t<std::remove_reference_t<decltype(field)>>;
+	if constexpr(is_range_column_v<field_type>){
+		const typename field_type::value_type value = object.*(field.member);
+		return static_cast<std::uint8_t>(!(value >= field.constraint.min) | !(value <= field.constraint.max));
+	}
+	else{
+		return 0;
+	}
+}
+
+template<class Object, std::size_t Index>
+/**
+ * Checks field of object, range constraints only when checkRanges is set.
+ **/
+void ValidateField(const Object& object, std::size_t position, bool checkRanges, std::vector<Violation>& violations){
+	constexpr const auto& field = schema_of<Object>.template field<Index>();
+	using field_type = std::remove_const_t<std::remove_reference_t<decltype(field)>>;
+	if constexpr(is_range_column_v<field_type>){
+		if(checkRanges && RangeViolated<Object, Index>(object) != 0){
+			violations.push_back(Violation{position, Index});
+		}
+	}
+	else if constexpr(is_constrained_v<field_type>){
+		if(!field.constraint(object.*(field.member))){
+			violations.push_back(Violation{position, Index});
+		}
+	}
+}
+
+template<class ObjectIt, std::size_t... Indices>
+void ValidateChunks(ObjectIt first, std::size_t count, std::vector<Violation>& violations, std::index_sequence<Indices...>){
+	using Object = typename std::iterator_traits<ObjectIt>::value_type;
+	constexpr const auto& schema = schema_of<Object>;
+	constexpr bool hasRanges = (is_range_column_v<std::remove_const_t<std::remove_reference_t<decltype(schema.template field<Indices>())>>> || ...);
+	constexpr bool hasOthers = ((is_constrained_v<std::remove_const_t<std::remove_reference_t<decltype(schema.template field<Indices>())>>>
+		&& !is_range_column_v<std::remove_const_t<std::remove_reference_t<decltype(schema.template field<Indices>())>>>) || ...);
+	constexpr std::size_t chunkSize = 256;
+
+	for(std::size_t chunk = 0; chunk < count; chunk += chunkSize){
+		const std::size_t size = std::min(chunkSize, count - chunk);
+		// all range constraints of chunk in one branchless pass, precise pass only runs when some of them failed
+		std::uint8_t rangeViolated = 0;
+		if constexpr(hasRanges){
+			for(std::size_t i = 0; i < size; ++i){
+				const Object& object = first[chunk + i];
+				rangeViolated |= (RangeViolated<Object, Indices>(object) | ...);
+			}
+		}
+		if(hasOthers || rangeViolated != 0){
+			for(std::size_t i = 0; i < size; ++i){
+				(ValidateField<Object, Indices>(first[chunk + i], chunk + i, rangeViolated != 0, violations), ...);
+			}
+		}
+	}
+}
+
+template<class Object, class Callable, std::size_t... Indices>
+bool ValidateFields(const Object& object, Callable& callable, std::index_sequence<Indices...>){
+	constexpr const auto& schema = schema_of<Object>;
+	bool valid = true;
+	auto check = [&object, &callable, &valid](std::size_t index, const auto& field){
+		if(field.constraint(object.*(field.member))){
+			return true;
+		}
+		valid = false;
+		return static_cast<bool>(callable(index, field.name));
+	};
+	(check(Indices, schema.template field<Indices>()) && ...);
+	return valid;
+}
+
+template<class Callable, class Schema, std::size_t... Indices>
+constexpr void VisitConstraintsImpl(const Schema& schema, Callable& callable, std::index_sequence<Indices...>){
+	(callable(schema.template field<Indices>().name, schema.template field<Indices>().constraint), ...);
+}
+
+}
+
+template<class Object, class Callable>
+/**
+ * Checks constraints of all fields of single object.
+ * 
+ * @param callable functor with signature bool(std::size_t fieldIndex, std::string_view name), called for each violated constraint.
+ * 
+ * @return true when object is valid, otherwise false
+ * 
+ * @note First call of callable which returns false will stop validation.
+ **/
+bool Validate(const Object& object, Callable&& callable){
+	return detail::ValidateFields(object, callable, std::make_index_sequence<detail::schema_type<Object>::size>{});
+}
+
+template<class Object>
+/**
+ * @return true when object satisfies constraints of all fields.
+ **/
+bool Validate(const Object& object){
+	return Validate(object, [](std::size_t, std::string_view){return false;});
+}
+
+template<class ObjectIt>
+/**
+ * Checks constraints of many objects in chunks, range constraints of arithmetic fields of whole chunk
+ *  are checked together in one pass without branches and chunks are checked field by field only when it failed.
+ * Violations are appended ordered by object, then by field.
+ * 
+ * @param first random access iterator to first object.
+ * @param last random access iterator past last object.
+ * 
+ * @return number of appended violations.
+ **/
+std::size_t ValidateObjects(ObjectIt first, ObjectIt last, std::vector<Violation>& violations){
+	using Object = typename std::iterator_traits<ObjectIt>::value_type;
+	const std::size_t previous = violations.size();
+	const std::size_t count = static_cast<std::size_t>(std::distance(first, last));
+	detail::ValidateChunks(first, count, violations, std::make_index_sequence<detail::schema_type<Object>::size>{});
+	return violations.size() - previous;
+}
+
+template<class Objects>
+/**
+ * @see ValidateObjects
+ **/
+std::size_t ValidateObjects(const Objects& objects, std::vector<Violation>& violations){
+	return ValidateObjects(std::begin(objects), std::end(objects), violations);
+}
+
+template<class Object, class Callable>
+/**
+ * Runs callable over constraint of each field of object schema, so tooling can inspect them.
+ * 
+ * @param callable functor with signature void(std::string_view name, const auto& constraint),
+ *  constraint type has static member kind (@see ConstraintKind).
+ **/
+constexpr void VisitConstraints(Callable&& callable){
+	detail::VisitConstraintsImpl(schema_of<Object>, callable, std::make_index_sequence<detail::schema_type<Object>::size>{});
+}
+}
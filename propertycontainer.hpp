@@ -0,0 +1,448 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#pragma once
+#include "property.hpp"
+
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace nap{
+
+namespace detail{
+
+template<class T, class = void>
+struct is_associative : std::false_type{};
+template<class T>
+struct is_associative<T, std::void_t<typename T::key_type, typename T::mapped_type>> : std::true_type{};
+
+template<class T, class = void>
+struct is_set : std::false_type{};
+template<class T>
+struct is_set<T, std::void_t<typename T::key_type>> : std::bool_constant<!is_associative<T>::value>{};
+
+template<class T, bool = is_associative<T>::value>
+struct element_of{using type = typename T::value_type;};
+template<class T>
+struct element_of<T, true>{using type = typename T::mapped_type;};
+
+template<class T, class = void>
+struct is_contiguous : std::false_type{};
+template<class T>
+struct is_contiguous<T, std::void_t<decltype(std::data(std::declval<T&>()))>> : std::true_type{};
+
+template<class T, class = void>
+struct is_resizable : std::false_type{};
+template<class T>
+struct is_resizable<T, std::void_t<decltype(std::declval<T&>().resize(std::size_t()))>> : std::true_type{};
+
+template<class PropertyT>
+/**
+ * Type erased operations over one container type, shared by all ContainerRef of that type.
+ **/
+struct ContainerAccess{
+	using any_type = typename PropertyT::any_type;
+	using ElementFunction = FunctionRef<bool(std::size_t index, const any_type* key, any_type& value)>;
+
+	typename PropertyT::interface::type_key (*elementKey)(); // function, since type keys (e.g. std::type_index) need not be constexpr
+	std::size_t elementSize;
+	bool associative;
+
+	std::size_t (*size)(const void* container);
+	bool (*forEach)(const void* container, std::size_t first, std::size_t count, ElementFunction callable);
+	bool (*write)(void* container, std::size_t index, any_type& value); // nullptr for sets, which elements are their keys
+	bool (*assign)(void* container, any_type& key, any_type& value);   // nullptr for sequences
+	bool (*resize)(void* container, std::size_t size);                 // nullptr when container can not be resized
+	const void* (*data)(const void* container);                        // nullptr unless elements are contiguous and trivially copyable
+};
+
+template<class PropertyT, class Container>
+/**
+ * Implementation of ContainerAccess for Container.
+ **/
+struct ContainerAccessOf{
+	using any_type  = typename PropertyT::any_type;
+	using interface = typename PropertyT::interface;
+
+	static constexpr bool associative = is_associative<Container>::value;
+	using element_type = typename element_of<Container>::type;
+	static constexpr bool trivial = is_contiguous<Container>::value && std::is_trivially_copyable_v<element_type>;
+
+	static_assert(associative || std::is_lvalue_reference_v<decltype(*std::begin(std::declval<Container&>()))>,
+		"containers which elements are accessed through proxy (e.g. std::vector<bool>) are not supported");
+
+	template<class Iterator>
+	static auto& Element(Iterator it){
+		if constexpr(associative){
+			return it->second;
+		}
+		else{
+			return *it;
+		}
+	}
+
+	static std::size_t Size(const void* container){
+		return std::size(*static_cast<const Container*>(container));
+	}
+	static bool ForEach(const void* container, std::size_t first, std::size_t count, typename ContainerAccess<PropertyT>::ElementFunction callable){
+		const Container& elements = *static_cast<const Container*>(container);
+		const std::size_t size = std::size(elements);
+		if(first > size){
+			return false;
+		}
+		const std::size_t last = (count > size - first) ? size : first + count;
+		auto it = std::next(std::begin(elements), first);
+		any_type key;
+		any_type value;
+		for(std::size_t index = first; index < last; ++index, ++it){
+			value = interface::template read<element_type>(Element(it));
+			if constexpr(associative){
+				key = interface::template read<typename Container::key_type>(it->first);
+				if(callable(index, &key, value) == false){
+					return false;
+				}
+			}
+			else if(callable(index, nullptr, value) == false){
+				return false;
+			}
+		}
+		return true;
+	}
+	static bool Write(void* container, std::size_t index, any_type& value){
+		Container& elements = *static_cast<Container*>(container);
+		if(index >= std::size(elements) || !Accepts<element_type>(value)){
+			return false;
+		}
+		interface::template write<element_type>(Element(std::next(std::begin(elements), index)), value);
+		return true;
+	}
+	static bool Assign(void* container, any_type& key, any_type& value){
+		using key_type = typename Container::key_type;
+		if(!Accepts<key_type>(key) || !Accepts<element_type>(value)){
+			return false;
+		}
+		Container& elements = *static_cast<Container*>(container);
+		const key_type& mappedKey = interface::template is_any<key_type&>(key) ?
+			interface::template cast_any<key_type&>(key) : interface::template cast_any<key_type>(key);
+		interface::template write<element_type>(elements[mappedKey], value);
+		return true;
+	}
+	static bool Resize(void* container, std::size_t size){
+		static_cast<Container*>(container)->resize(size);
+		return true;
+	}
+	static const void* Data(const void* container){
+		return std::data(*static_cast<const Container*>(container));
+	}
+
+	template<typename T>
+	static bool Accepts(const any_type& value){
+		return interface::template is_any<T>(value) || interface::template is_any<T&>(value);
+	}
+};
+
+template<class PropertyT, class Container>
+/**
+ * ContainerAccess of Container, constant initialized so it can be used from initialization of other statics.
+ **/
+inline constexpr ContainerAccess<PropertyT> container_access_of{
+	&PropertyT::interface::template key_of<typename ContainerAccessOf<PropertyT, Container>::element_type>,
+	sizeof(typename ContainerAccessOf<PropertyT, Container>::element_type),
+	ContainerAccessOf<PropertyT, Container>::associative,
+	&ContainerAccessOf<PropertyT, Container>::Size,
+	&ContainerAccessOf<PropertyT, Container>::ForEach,
+	[](){
+		if constexpr(is_set<Container>::value){
+			return static_cast<bool (*)(void*, std::size_t, typename PropertyT::any_type&)>(nullptr);
+		}
+		else{
+			return &ContainerAccessOf<PropertyT, Container>::Write;
+		}
+	}(),
+	[](){
+		if constexpr(ContainerAccessOf<PropertyT, Container>::associative){
+			return &ContainerAccessOf<PropertyT, Container>::Assign;
+		}
+		else{
+			return static_cast<bool (*)(void*, typename PropertyT::any_type&, typename PropertyT::any_type&)>(nullptr);
+		}
+	}(),
+	[](){
+		if constexpr(is_resizable<Container>::value){
+			return &ContainerAccessOf<PropertyT, Container>::Resize;
+		}
+		else{
+			return static_cast<bool (*)(void*, std::size_t)>(nullptr);
+		}
+	}(),
+	[](){
+		if constexpr(ContainerAccessOf<PropertyT, Container>::trivial){
+			return &ContainerAccessOf<PropertyT, Container>::Data;
+		}
+		else{
+			return static_cast<const void* (*)(const void*)>(nullptr);
+		}
+	}()
+};
+}
+
+template<class PropertyT>
+/**
+ * Type erased refference to container read from property, giving access to its size and elements without knowing its type.
+ * Elements are read into any_type one by one, or for contiguous trivially copyable elements copied in bulk.
+ * Elements of sets (e.g. std::set, std::unordered_set) are read only, since they are keys of the set.
+ * 
+ * Index based access (read, write, forEach from first) advances iterator from beginning of container,
+ *  which takes O(index) for containers without random access (maps, sets, lists),
+ *  so such containers should be walked by single forEach over whole range instead of element by element or in many chunks.
+ * 
+ * Refference is valid as long as referenced container is alive and is not reallocated by others.
+ **/
+class ContainerRef{
+public: // type definitions
+	using any_type = typename PropertyT::any_type;
+	using type_key = typename PropertyT::interface::type_key;
+
+public: // functions
+	ContainerRef() = default;
+	ContainerRef(const detail::ContainerAccess<PropertyT>* access, const void* container, void* mutableContainer) :
+	m_access(access), m_container(container), m_mutable(mutableContainer)
+	{}
+
+	/**
+	 * @return true when refference points to container.
+	 **/
+	explicit operator bool() const{return (m_access != nullptr);}
+	/**
+	 * @return true when elements can be written.
+	 **/
+	bool isWritable() const{return (m_mutable != nullptr);}
+	/**
+	 * @return true for associative containers (e.g. std::map), which elements are mapped values in iteration order.
+	 **/
+	bool isAssociative() const{return m_access->associative;}
+	/**
+	 * @return true when elements are contiguous and trivially copyable, so they can be accessed via data() and copied in bulk.
+	 **/
+	bool isContiguous() const{return (m_access->data != nullptr);}
+
+	std::size_t size() const{return m_access->size(m_container);}
+	/**
+	 * @return interface type key of element (mapped value for associative containers).
+	 **/
+	type_key elementKey() const{return m_access->elementKey();}
+	std::size_t elementSize() const{return m_access->elementSize;}
+
+	/**
+	 * @return pointer to first element of contiguous container, otherwise nullptr.
+	 **/
+	const void* data() const{return isContiguous() ? m_access->data(m_container) : nullptr;}
+	/**
+	 * @return size of all elements in bytes for contiguous container, otherwise 0.
+	 **/
+	std::size_t byteSize() const{return isContiguous() ? size() * elementSize() : 0;}
+
+	template<class Callable>
+	/**
+	 * Runs callable over range of elements, element values are read into one reused any_type.
+	 * 
+	 * @param first index of first element.
+	 * @param count maximal number of elements, range is clamped to size of container.
+	 * @param callable functor with signature bool(std::size_t index, any_type& value).
+	 * 
+	 * @return false when first is out of range or callable returned false, otherwise true.
+	 **/
+	bool forEach(std::size_t first, std::size_t count, Callable&& callable) const{
+		auto element = [&callable](std::size_t index, const any_type*, any_type& value) -> bool{
+			return callable(index, value);
+		};
+		return m_access->forEach(m_container, first, count, element);
+	}
+	template<class Callable>
+	/**
+	 * Runs callable over range of entries of associative container.
+	 * 
+	 * @param callable functor with signature bool(std::size_t index, const any_type& key, any_type& value).
+	 * 
+	 * @return false when container is not associative, first is out of range or callable returned false, otherwise true.
+	 **/
+	bool forEachEntry(std::size_t first, std::size_t count, Callable&& callable) const{
+		if(!isAssociative()){
+			return false;
+		}
+		auto entry = [&callable](std::size_t index, const any_type* key, any_type& value) -> bool{
+			return callable(index, *key, value);
+		};
+		return m_access->forEach(m_container, first, count, entry);
+	}
+
+	/**
+	 * Reads single element.
+	 * 
+	 * @return false when index is out of range, otherwise true.
+	 **/
+	bool read(std::size_t index, any_type& value) const{
+		bool found = false;
+		forEach(index, 1,
+			[&value, &found](std::size_t, any_type& element){
+				value = element;
+				found = true;
+				return true;
+			}
+		);
+		return found;
+	}
+	/**
+	 * Writes single element, for associative containers mapped value at iteration index.
+	 * 
+	 * @return false when container is not writable or is set, index is out of range or value is of different type, otherwise true.
+	 **/
+	bool write(std::size_t index, any_type& value) const{
+		return isWritable() && (m_access->write != nullptr) && m_access->write(m_mutable, index, value);
+	}
+	/**
+	 * Inserts or assigns mapped value of associative container.
+	 * 
+	 * @return false when container is not writable nor associative or key/value are of different types, otherwise true.
+	 **/
+	bool assign(any_type& key, any_type& value) const{
+		return isWritable() && (m_access->assign != nullptr) && m_access->assign(m_mutable, key, value);
+	}
+	/**
+	 * @return false when container is not writable or can not be resized, otherwise true.
+	 **/
+	bool resize(std::size_t size) const{
+		return isWritable() && (m_access->resize != nullptr) && m_access->resize(m_mutable, size);
+	}
+
+	/**
+	 * Copies range of contiguous elements into output.
+	 * 
+	 * @param output buffer of at least count * elementSize() bytes.
+	 * 
+	 * @return false when container is not contiguous or range is out of bounds, otherwise true.
+	 **/
+	bool readBytes(std::size_t first, std::size_t count, void* output) const{
+		if(!isContiguous() || first > size() || count > size() - first){
+			return false;
+		}
+		if(count != 0){
+			std::memcpy(output, static_cast<const char*>(data()) + first * elementSize(), count * elementSize());
+		}
+		return true;
+	}
+	/**
+	 * Copies input into range of contiguous elements, container has to be resized up front.
+	 * 
+	 * @param input buffer of at least count * elementSize() bytes.
+	 * 
+	 * @return false when container is not writable nor contiguous or range is out of bounds, otherwise true.
+	 **/
+	bool writeBytes(std::size_t first, std::size_t count, const void* input) const{
+		if(!isWritable() || !isContiguous() || first > size() || count > size() - first){
+			return false;
+		}
+		if(count != 0){
+			char* elements = static_cast<char*>(const_cast<void*>(m_access->data(m_mutable)));
+			std::memcpy(elements + first * elementSize(), input, count * elementSize());
+		}
+		return true;
+	}
+
+private: // members
+	const detail::ContainerAccess<PropertyT>* m_access = nullptr;
+	const void* m_container = nullptr;
+	void* m_mutable = nullptr;
+};
+
+template<class PropertyT, class... Containers>
+/**
+ * Table of container types recognized in values of properties, dispatched by single lookup of interface type key.
+ * 
+ * Usage:
+ *   using MeshContainers = nap::ContainerTable<Property, std::vector<float>, std::vector<int>, std::map<std::string, int>>;
+ *   if(nap::ContainerRef<Property> container = MeshContainers::Find(property)){
+ *       container.readBytes(0, container.size(), output); // or container.forEach(...)
+ *   }
+ **/
+class ContainerTable{
+public: // type definitions
+	using any_type  = typename PropertyT::any_type;
+	using interface = typename PropertyT::interface;
+
+public: // static functions
+	/**
+	 * Reads property and refferences container stored in it.
+	 * Container is writable when property exposes it by mutable refference,
+	 *  or when property was constructed directly from writable variable.
+	 * 
+	 * @return refference to container, empty when property is not readable or holds other type.
+	 **/
+	static ContainerRef<PropertyT> Find(const PropertyT& property){
+		if(!property.isReadable()){
+			return {};
+		}
+		any_type value;
+		property.read(value);
+		return Find(value, property.isVariable() && property.isWritable());
+	}
+	/**
+	 * Refferences container stored in value.
+	 * 
+	 * @param writable allows writing into container stored by const refference, only when it is known to be non-const.
+	 * 
+	 * @return refference to container, empty when value holds other type.
+	 **/
+	static ContainerRef<PropertyT> Find(any_type& value, bool writable = false){
+		// built once per table, so lookups do not allocate
+		static const std::unordered_map<typename interface::type_key, Entry> table = {
+			{interface::template key_of<Containers>(), Entry{&detail::container_access_of<PropertyT, Containers>, &Pointer<Containers>}}...,
+			{interface::template key_of<Containers&>(), Entry{&detail::container_access_of<PropertyT, Containers>, &MutablePointer<Containers>}}...
+		};
+		auto itEntry = table.find(interface::key_of(value));
+		if(itEntry == table.end()){
+			return {};
+		}
+		auto [container, isMutable] = itEntry->second.pointer(value);
+		return ContainerRef<PropertyT>(itEntry->second.access, container, (isMutable || writable) ? const_cast<void*>(container) : nullptr);
+	}
+
+private: // type definitions
+	struct Entry{
+		const detail::ContainerAccess<PropertyT>* access;
+		std::pair<const void*, bool> (*pointer)(any_type& value);
+	};
+
+private: // static functions
+	template<class Container>
+	static std::pair<const void*, bool> Pointer(any_type& value){
+		return {std::addressof(interface::template cast_any<Container>(value)), false};
+	}
+	template<class Container>
+	static std::pair<const void*, bool> MutablePointer(any_type& value){
+		return {std::addressof(interface::template cast_any<Container&>(value)), true};
+	}
+};
+}
@@ -24,7 +24,12 @@
 #include "property.hpp"
 
 #include <any>
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <string_view>
+#include <type_traits>
+#include <typeindex>
 
 namespace nap{
 
@@ -76,6 +81,31 @@ struct DefaultInterface{
 			return (any.type() == typeid(internal_type<const T>));
 		}
 	}
+	/**
+	 * Stable key of type stored in any_type, used for table based type dispatch.
+	 * key_of<T>() follows the same rules as is_any<T>, so key_of(any) == key_of<T>() when is_any<T>(any).
+	 **/
+	using type_key = std::type_index;
+
+	template<typename T>
+	static type_key key_of(){
+		if constexpr(std::is_reference_v<T>){
+			return typeid(internal_type<T>);
+		}
+		else{
+			return typeid(internal_type<const T>);
+		}
+	}
+	static type_key key_of(const any_type& any){
+		return any.type();
+	}
+	/**
+	 * Cheap hash of type key, address of its type name instead of hashing the name itself.
+	 * Relies on single type_info per type, as within program and shared libraries with default visibility.
+	 **/
+	static std::size_t hash_key(const type_key& key){
+		return reinterpret_cast<std::uintptr_t>(key.name());
+	}
 	template<typename T>
 	static auto read(T& value){
 		return make_any<const T&>(value);
@@ -86,12 +116,19 @@ struct DefaultInterface{
 	}
 	template<typename T>
 	static void write(T& value, any_type& any){
-		try{
-			value = std::move(cast_any<T&>(any));
+		// check stored pointer type up front, so const entries fall back to copy without throwing
+		if(internal_type<T>* movable = std::any_cast<internal_type<T>>(&any)){
+			value = std::move(**movable);
 			return;
 		}
-		catch(const std::bad_any_cast&){/* write by move failed */}
-		// try write by copy
+		if constexpr(std::is_same_v<T, std::string>){
+			// text kept outside of std::string (e.g. in VisitArena) is assigned into capacity of the member
+			if(const std::string_view* const* text = std::any_cast<const std::string_view*>(&any)){
+				value.assign((*text)->data(), (*text)->size());
+				return;
+			}
+		}
+		// write by copy
 		value = cast_any<const T&>(any);
 	}
 
@@ -114,4 +151,9 @@ struct DefaultInterface{
  * Property template with default implementation of the interface using std::any and small object optimizations.
  **/
 using Property = PropertyTemplate<detail::DefaultInterface>;
+/**
+ * Property template with default implementation of the interface,
+ *  keeping functors as non-owning refferences, so constructing and visiting properties never allocates.
+ **/
+using PropertyRef = PropertyTemplate<detail::DefaultInterface, detail::FunctionRefStorage>;
 }
\ No newline at end of file
@@ -0,0 +1,222 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#pragma once
+#include "property.hpp"
+#include "propertybatch.hpp"
+#include "propertybinary.hpp"
+#include "propertydirty.hpp"
+#include "propertyschema.hpp"
+
+#include <type_traits>
+#include <utility>
+
+namespace nap{
+
+namespace detail{
+
+template<class Member>
+bool EqualMembers(const Member& left, const Member& right);
+
+template<class Object, std::size_t... Indices>
+bool EqualFields(const Object& left, const Object& right, std::index_sequence<Indices...>){
+	constexpr const auto& schema = schema_of<Object>;
+	return (EqualMembers(left.*(schema.template field<Indices>().member), right.*(schema.template field<Indices>().member)) && ...);
+}
+
+template<class Member>
+/**
+ * Members declaring schema are compared field by field, others by EqualValues.
+ **/
+bool EqualMembers(const Member& left, const Member& right){
+	if constexpr(has_schema_v<Member>){
+		return EqualFields(left, right, std::make_index_sequence<schema_type<Member>::size>{});
+	}
+	else{
+		return EqualValues(left, right);
+	}
+}
+
+template<class PropertyT, class TypeTable>
+/**
+ * Writes delta entry of property at position, nested property is written whole as delta of its children.
+ **/
+void EncodeEntry(BinaryOutput& output, std::size_t position, const PropertyT& property){
+	if(property.isNested()){
+		output.putVarint(position + 1);
+		std::size_t childPosition = 0;
+		auto encodeChild = [&output, &childPosition](const PropertyT& child){
+			EncodeEntry<PropertyT, TypeTable>(output, childPosition++, child);
+			return !output.overflow();
+		};
+		property.visitChildren(PropertyT::Visitor::Reference(encodeChild));
+		output.putVarint(0);
+	}
+	else if(property.isReadable()){
+		typename PropertyT::any_type value;
+		property.read(value);
+		if(auto entry = TypeTable::Find(value)){
+			output.putVarint(position + 1);
+			entry->encode(output, value);
+		}
+	}
+}
+
+template<class Object, class Mask, std::size_t... Indices>
+bool DiffFieldsImpl(const Object& current, const Object& baseline, Mask& mask, std::index_sequence<Indices...>){
+	constexpr const auto& schema = schema_of<Object>;
+	bool changed = false;
+	((EqualMembers(current.*(schema.template field<Indices>().member), baseline.*(schema.template field<Indices>().member))
+		? void() : (mask.markDirty(Indices), changed = true, void())), ...);
+	return changed;
+}
+}
+
+/**
+ * Mask with one bit per field of object schema (bit index == field index).
+ **/
+template<class Object>
+using FieldMask = DirtyMask<detail::schema_type<Object>::size>;
+
+template<class Object, std::size_t Size>
+/**
+ * Compares two objects field by field in lockstep, without constructing properties nor reading any values,
+ *  trivially copyable members are compared by memcmp (@see detail::EqualValues).
+ * Bits of changed fields are set in mask, bits of equal fields are left unchanged.
+ * 
+ * @return true when any field differs.
+ **/
+bool DiffFields(const Object& current, const Object& baseline, DirtyMask<Size>& mask){
+	static_assert(Size >= detail::schema_type<Object>::size, "mask is smaller than schema");
+	return detail::DiffFieldsImpl(current, baseline, mask, std::make_index_sequence<detail::schema_type<Object>::size>{});
+}
+
+template<class PropertyT, class TypeTable = detail::DefaultBinaryTypes<PropertyT>, class Object, std::size_t Size>
+/**
+ * Writes values of fields marked in mask (e.g. by DiffFields) into caller provided buffer, using format of BinaryDeltaWriter
+ *  where position of field is its index in schema. Nested fields are written whole, fields of unsupported types are skipped.
+ * 
+ * @return size of patch, or 0 when buffer is too small.
+ **/
+std::size_t WriteFieldPatch(Object& object, const DirtyMask<Size>& mask, char* data, std::size_t capacity){
+	detail::BinaryOutput output(data, capacity);
+	mask.forEachDirty(
+		[&object, &output](std::size_t index){
+			auto encode = [&output, index](const PropertyT& property){
+				detail::EncodeEntry<PropertyT, TypeTable>(output, index, property);
+				return !output.overflow();
+			};
+			schema_of<Object>.template visitProperty<PropertyT>(PropertyT::Visitor::Reference(encode), object, index);
+			return !output.overflow();
+		}
+	);
+	output.putVarint(0);
+	return output.overflow() ? 0 : output.size();
+}
+
+template<class PropertyT, class TypeTable = detail::DefaultBinaryTypes<PropertyT>, class Object>
+/**
+ * Applies patch written by WriteFieldPatch (or BinaryDiffWriter over schema properties) to object.
+ * 
+ * @return true when whole patch was applied.
+ **/
+bool ApplyFieldPatch(Object& object, const char* data, std::size_t size){
+	BinaryDeltaReader<PropertyT, TypeTable> reader(data, size);
+	schema_of<Object>.template visitProperties<PropertyT>(PropertyT::Visitor::Reference(reader), object);
+	return reader.finish();
+}
+
+template<class PropertyT, class TypeTable = detail::DefaultBinaryTypes<PropertyT>>
+/**
+ * Visitor comparing visited properties with baseline values at the same positions (read earlier into PropertyBuffer)
+ *  and writing only changed values, in format of BinaryDeltaWriter, so patch is applied by BinaryDeltaReader.
+ * Values are compared by type codec of TypeTable, properties without baseline value are written whenever readable
+ *  and nested properties are always written whole.
+ * 
+ * Usage:
+ *   PropertyBuffer<Property> baseline;
+ *   auto reader = baseline.reader();
+ *   saved.propertiesFunc(Property::Visitor::Reference(reader));
+ *   BinaryDiffWriter<Property> writer(baseline, buffer, sizeof(buffer));
+ *   live.propertiesFunc(Property::Visitor::Reference(writer));
+ *   if(writer.finish()) send(buffer, writer.size());
+ * 
+ * @note values of types outside of buffer columns refference members of saved object, which has to outlive diff then.
+ **/
+class BinaryDiffWriter{
+public: // functions
+	BinaryDiffWriter(const PropertyBuffer<PropertyT>& baseline, char* data, std::size_t capacity) : m_baseline(baseline), m_output(data, capacity){}
+
+	/**
+	 * @return false when buffer is too small, otherwise true.
+	 **/
+	bool operator()(const PropertyT& property){
+		std::size_t position = m_position++;
+		if(property.isNested()){
+			// children have no baseline, so nested property is written whole
+			detail::EncodeEntry<PropertyT, TypeTable>(m_output, position, property);
+			++m_changed;
+			return !m_output.overflow();
+		}
+		if(!property.isReadable()){
+			return true;
+		}
+		typename PropertyT::any_type value;
+		property.read(value);
+		auto entry = TypeTable::Find(value);
+		if(entry == nullptr){
+			return true;
+		}
+		if(m_baseline.isRead(position)){
+			const typename PropertyT::any_type baseline = m_baseline.value(position);
+			if(TypeTable::Find(baseline) == entry && entry->equal(value, baseline)){
+				return true;
+			}
+		}
+		m_output.putVarint(position + 1);
+		entry->encode(m_output, value);
+		++m_changed;
+		return !m_output.overflow();
+	}
+	/**
+	 * Terminates patch, has to be called after all properties were visited.
+	 * 
+	 * @return false when buffer was too small, otherwise true.
+	 **/
+	bool finish(){
+		m_output.putVarint(0);
+		return !m_output.overflow();
+	}
+
+	std::size_t size() const{return m_output.size();}
+	/**
+	 * @return number of changed properties written into patch.
+	 **/
+	std::size_t changed() const{return m_changed;}
+
+private: // members
+	const PropertyBuffer<PropertyT>& m_baseline;
+	detail::BinaryOutput m_output;
+	std::size_t m_position = 0;
+	std::size_t m_changed = 0;
+};
+}
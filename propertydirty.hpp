@@ -0,0 +1,303 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#pragma once
+#include "property.hpp"
+#include "propertybinary.hpp"
+#include "propertyschema.hpp"
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace nap{
+
+template<std::size_t Size>
+/**
+ * Per object dirty bits, one for each tracked property (or schema field).
+ * Bits are set by writes of tracked properties, or by markDirty when member is changed directly,
+ *  and cleared by owner after changes were synchronized.
+ **/
+class DirtyMask{
+public: // static members
+	static constexpr std::size_t size = Size;
+
+public: // functions
+	/**
+	 * @return dirty flag of bit at index, which can be passed to PropertyTemplate::tracked.
+	 **/
+	detail::DirtyFlag flag(std::size_t index){
+		return detail::DirtyFlag{&m_words[index / 64], 1ull << (index % 64)};
+	}
+
+	void markDirty(std::size_t index){m_words[index / 64] |= (1ull << (index % 64));}
+	bool isDirty(std::size_t index) const{return (m_words[index / 64] & (1ull << (index % 64))) != 0;}
+	void clear(std::size_t index){m_words[index / 64] &= ~(1ull << (index % 64));}
+	void clear(){m_words.fill(0);}
+
+	/**
+	 * @return true when any bit is set.
+	 **/
+	bool any() const{
+		for(std::uint64_t word : m_words){
+			if(word != 0){
+				return true;
+			}
+		}
+		return false;
+	}
+
+	template<class Callable>
+	/**
+	 * Runs callable over indices of set bits in ascending order, skipping clean words at once.
+	 * 
+	 * @param callable functor with signature bool(std::size_t index).
+	 * 
+	 * @return true when all callable calls returned true, otherwise false
+	 **/
+	bool forEachDirty(const Callable& callable) const{
+		for(std::size_t wordIndex = 0; wordIndex < m_words.size(); ++wordIndex){
+			std::uint64_t word = m_words[wordIndex];
+			while(word != 0){
+				std::size_t bit = CountTrailingZeros(word);
+				word &= word - 1;
+				if(callable(wordIndex * 64 + bit) == false){
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+private: // static functions
+	static std::size_t CountTrailingZeros(std::uint64_t word){
+#if defined(__GNUC__) || defined(__clang__)
+		return static_cast<std::size_t>(__builtin_ctzll(word));
+#else
+		std::size_t count = 0;
+		while((word & 1) == 0){
+			word >>= 1;
+			++count;
+		}
+		return count;
+#endif
+	}
+
+private: // members
+	std::array<std::uint64_t, (Size + 63) / 64> m_words{};
+};
+
+namespace detail{
+
+template<class PropertyArray>
+using element_type_t = std::decay_t<decltype(*std::begin(std::declval<const PropertyArray&>()))>;
+
+template<class Callable, class PropertyT>
+/**
+ * Runs visitor over property when it is dirty, nested properties are descended into instead.
+ **/
+bool VisitIfDirty(Callable& visitor, const PropertyT& property){
+	if(property.isNested()){
+		auto visitChild = [&visitor](const PropertyT& child){
+			return VisitIfDirty(visitor, child);
+		};
+		return property.visitChildren(PropertyT::Visitor::Reference(visitChild));
+	}
+	return !property.isDirty() || InvokeVisitor(visitor, property);
+}
+}
+
+template<class Callable, class PropertyArray, typename = detail::enable_if_visitor_t<Callable, detail::element_type_t<PropertyArray>>>
+/**
+ * Runs visitor only over dirty properties of container, clean properties are not read.
+ * Nested properties are descended into, so their dirty children are visited in their place.
+ * 
+ * @see PropertyTemplate::Visitor::visit
+ **/
+bool VisitDirty(Callable&& visitor, const PropertyArray& properties){
+	for(const auto& property : properties){
+		if(detail::VisitIfDirty(visitor, property) == false){
+			return false;
+		}
+	}
+	return true;
+}
+
+template<class Callable, class PropertyT, typename = detail::enable_if_visitor_t<Callable, PropertyT>>
+/**
+ * Runs visitor only over dirty properties of initializer list, clean properties are not read.
+ * Nested properties are descended into, so their dirty children are visited in their place.
+ * 
+ * @see PropertyTemplate::Visitor::visit
+ **/
+bool VisitDirty(Callable&& visitor, std::initializer_list<PropertyT> ilProperties){
+	for(const auto& property : ilProperties){
+		if(detail::VisitIfDirty(visitor, property) == false){
+			return false;
+		}
+	}
+	return true;
+}
+
+template<class Object, std::size_t Size, class Callable>
+/**
+ * Runs callable only over fields of object schema which are marked in mask (bit index == field index),
+ *  dispatching directly to each dirty field without walking the others.
+ * 
+ * @param callable functor with signature bool(std::string_view name, auto& member).
+ **/
+bool VisitDirtyFields(Object& object, const DirtyMask<Size>& mask, Callable&& callable){
+	return mask.forEachDirty(
+		[&object, &callable](std::size_t index){
+			return schema_of<Object>.visitField(object, index, callable);
+		}
+	);
+}
+
+template<class PropertyT, class TypeTable = detail::DefaultBinaryTypes<PropertyT>>
+/**
+ * Visitor writing only dirty properties into caller provided buffer.
+ * Each value is prefixed by varint position of property in visited list + 1 (name only properties included),
+ *  and delta is terminated by 0. Dirty flags are left unchanged, so they can be cleared once delta was sent.
+ * Nested property with any dirty child is written as its position + 1 followed by delta of its children.
+ * 
+ * Usage:
+ *   BinaryDeltaWriter<Property> writer(buffer, sizeof(buffer));
+ *   object.propertiesFunc(Property::Visitor::Reference(writer));
+ *   if(writer.finish()) send(buffer, writer.size()), mask.clear();
+ **/
+class BinaryDeltaWriter{
+public: // functions
+	BinaryDeltaWriter(char* data, std::size_t capacity) : m_output(data, capacity){}
+
+	/**
+	 * @return false when buffer is too small, otherwise true.
+	 **/
+	bool operator()(const PropertyT& property){
+		std::size_t position = m_position++;
+		if(property.isNested()){
+			const std::size_t start = m_output.size();
+			m_output.putVarint(position + 1);
+			BinaryDeltaWriter child(m_output);
+			const bool result = property.visitChildren(PropertyT::Visitor::Reference(child));
+			m_output = child.m_output;
+			if(!result){
+				return false;
+			}
+			if(m_output.size() == child.m_start){
+				m_output.truncate(start); // no dirty children
+			}
+			else{
+				m_output.putVarint(0);
+			}
+			return !m_output.overflow();
+		}
+		if(!property.isDirty() || !property.isReadable()){
+			return true;
+		}
+		typename PropertyT::any_type value;
+		property.read(value);
+		if(auto entry = TypeTable::Find(value)){
+			m_output.putVarint(position + 1);
+			entry->encode(m_output, value);
+		}
+		return !m_output.overflow();
+	}
+	/**
+	 * Terminates delta, has to be called after all properties were visited.
+	 * 
+	 * @return false when buffer was too small, otherwise true.
+	 **/
+	bool finish(){
+		m_output.putVarint(0);
+		return !m_output.overflow();
+	}
+
+	std::size_t size() const{return m_output.size();}
+
+private: // functions
+	explicit BinaryDeltaWriter(const detail::BinaryOutput& output) : m_output(output), m_start(output.size()){}
+
+private: // members
+	detail::BinaryOutput m_output;
+	std::size_t m_start = 0;
+	std::size_t m_position = 0;
+};
+
+template<class PropertyT, class TypeTable = detail::DefaultBinaryTypes<PropertyT>>
+/**
+ * Visitor applying delta written by BinaryDeltaWriter, properties without value in delta are not read nor written.
+ * Entry of nested property holds delta of its children, terminated by 0.
+ **/
+class BinaryDeltaReader{
+public: // functions
+	BinaryDeltaReader(const char* data, std::size_t size) : BinaryDeltaReader(detail::BinaryInput(data, size)){}
+
+	/**
+	 * @return false when delta is malformed, otherwise true.
+	 **/
+	bool operator()(const PropertyT& property){
+		std::size_t position = ++m_position;
+		if(m_next != position){
+			return true;
+		}
+		if(property.isNested()){
+			BinaryDeltaReader child(m_input);
+			if(!property.visitChildren(PropertyT::Visitor::Reference(child)) || !child.finish()){
+				return false;
+			}
+			m_input = child.m_input;
+			m_next = m_input.getVarint();
+			return !m_input.underflow();
+		}
+		if(!property.isReadable()){
+			return false;
+		}
+		typename PropertyT::any_type value;
+		property.read(value);
+		auto entry = TypeTable::Find(value);
+		if(entry == nullptr || !entry->decode(m_input, property, m_scratch)){
+			return false;
+		}
+		m_next = m_input.getVarint();
+		return !m_input.underflow();
+	}
+	/**
+	 * @return true when whole delta was applied.
+	 **/
+	bool finish() const{return (m_next == 0) && !m_input.underflow();}
+
+private: // functions
+	explicit BinaryDeltaReader(const detail::BinaryInput& input) : m_input(input){
+		m_next = m_input.getVarint();
+	}
+
+private: // members
+	detail::BinaryInput m_input;
+	std::uint64_t m_next = 0;
+	std::size_t m_position = 0;
+	std::string m_scratch;
+};
+}
@@ -0,0 +1,376 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Opt-in instrumentation of property reads, writes and visits.
+ * Hooks in PropertyTemplate and stock visitors are compiled only when NAP_INSTRUMENTATION is defined,
+ *  otherwise this header is not included and hooks expand to nothing.
+ * Bytes are counted only by binary archive (BinaryWriter and BinaryReader), other operations record calls and time.
+ * 
+ * @note The define changes bodies of inline functions in property.hpp, so all translation units of a program
+ *  have to agree on it (e.g. set it for whole target via CMake option), mixing them violates the one definition rule.
+ **/
+namespace nap{
+namespace instrumentation{
+
+enum class Operation : std::size_t{
+	Read,
+	Write,
+	Visit,
+};
+inline constexpr std::size_t operation_count = 3;
+/**
+ * Latency histogram bucket i counts calls which took [2^i, 2^(i+1)) nanoseconds (bucket 0 also holds 0 ns).
+ **/
+inline constexpr std::size_t histogram_buckets = 32;
+
+/**
+ * Aggregated counters of single operation over single property.
+ **/
+struct OperationStats{
+	std::uint64_t calls = 0;
+	std::uint64_t nanoseconds = 0;
+	std::uint64_t bytes = 0;
+	std::array<std::uint64_t, histogram_buckets> histogram{};
+};
+
+/**
+ * Aggregated counters of all operations over single property name, from all threads.
+ **/
+struct PropertyStats{
+	std::string name;
+	std::array<OperationStats, operation_count> operations;
+
+	const OperationStats& operator[](Operation operation) const{return operations[static_cast<std::size_t>(operation)];}
+};
+
+namespace detail{
+
+/**
+ * Counter written by single owning thread and read by reporting thread,
+ *  so increments do not need atomic read-modify-write.
+ **/
+class Counter{
+public: // functions
+	void add(std::uint64_t value){m_value.store(m_value.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);}
+	std::uint64_t load() const{return m_value.load(std::memory_order_relaxed);}
+	void reset(){m_value.store(0, std::memory_order_relaxed);}
+
+private: // members
+	std::atomic<std::uint64_t> m_value{0};
+};
+
+struct OperationCounters{
+	Counter calls;
+	Counter nanoseconds;
+	Counter bytes;
+	std::array<Counter, histogram_buckets> histogram;
+
+	void record(std::uint64_t elapsed){
+		calls.add(1);
+		nanoseconds.add(elapsed);
+		histogram[Bucket(elapsed)].add(1);
+	}
+	void collect(OperationStats& stats) const{
+		stats.calls += calls.load();
+		stats.nanoseconds += nanoseconds.load();
+		stats.bytes += bytes.load();
+		for(std::size_t i = 0; i < histogram_buckets; ++i){
+			stats.histogram[i] += histogram[i].load();
+		}
+	}
+	void reset(){
+		calls.reset();
+		nanoseconds.reset();
+		bytes.reset();
+		for(Counter& bucket : histogram){
+			bucket.reset();
+		}
+	}
+
+	static std::size_t Bucket(std::uint64_t elapsed){
+		std::size_t bucket = 0;
+		while(elapsed > 1 && bucket + 1 < histogram_buckets){
+			elapsed >>= 1;
+			++bucket;
+		}
+		return bucket;
+	}
+};
+
+struct PropertyCounters{
+	std::string name;
+	std::array<OperationCounters, operation_count> operations;
+};
+
+/**
+ * @return id of next instrumented call site, each hook takes one into its static variable on first use.
+ **/
+inline std::size_t NextCallSite(){
+	static std::atomic<std::size_t> next{0};
+	return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * Counters of properties used by single thread, keyed by hash of property name.
+ * Each call site caches counters of recently seen names by address of name characters,
+ *  so repeated calls with the same name (e.g. string literal) neither hash the name nor search the map.
+ * Only owning thread inserts (under mutex) and uses the caches, reporting thread reads counters under the same mutex.
+ **/
+class ThreadCounters{
+public: // functions
+	OperationCounters& find(std::size_t site, Operation operation, std::string_view name){
+		if(site >= m_sites.size()){
+			m_sites.resize(site + 1);
+		}
+		CacheEntry& entry = m_sites[site][CacheSlot(name.data())];
+		// characters are compared as well, since address could be reused by other name
+		if(entry.counters == nullptr || entry.data != name.data() || entry.counters->name != name){
+			entry = CacheEntry{name.data(), &findCounters(name)};
+		}
+		return entry.counters->operations[static_cast<std::size_t>(operation)];
+	}
+
+	template<class Callable>
+	void forEach(const Callable& callable){
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for(auto& [hash, counters] : m_counters){
+			callable(counters);
+		}
+	}
+
+private: // type definitions
+	struct CacheEntry{
+		const char* data = nullptr;
+		PropertyCounters* counters = nullptr; // map nodes are stable
+	};
+	using SiteCache = std::array<CacheEntry, 16>;
+
+private: // functions
+	PropertyCounters& findCounters(std::string_view name){
+		std::uint64_t hash = Hash(name);
+		for(;;){
+			auto itCounters = m_counters.find(hash);
+			if(itCounters == m_counters.end()){
+				std::lock_guard<std::mutex> lock(m_mutex);
+				PropertyCounters& counters = m_counters[hash];
+				counters.name.assign(name.data(), name.size());
+				return counters;
+			}
+			if(itCounters->second.name == name){
+				return itCounters->second;
+			}
+			// different name with the same hash, probe next one
+			++hash;
+		}
+	}
+
+private: // static functions
+	static std::size_t CacheSlot(const char* data){
+		return static_cast<std::size_t>((reinterpret_cast<std::uintptr_t>(data) * 0x9E3779B97F4A7C15ull) >> 60);
+	}
+	static std::uint64_t Hash(std::string_view name){
+		std::uint64_t hash = 0xcbf29ce484222325ull;
+		for(char ch : name){
+			hash ^= static_cast<unsigned char>(ch);
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+private: // members
+	std::mutex m_mutex;
+	std::unordered_map<std::uint64_t, PropertyCounters> m_counters;
+	std::vector<SiteCache> m_sites; // indexed by call site id
+};
+
+/**
+ * Counters of all threads, kept alive after their threads exit so their calls stay in report.
+ **/
+struct Registry{
+	std::mutex mutex;
+	std::vector<std::shared_ptr<ThreadCounters>> threads;
+
+	static Registry& Get(){
+		static Registry registry;
+		return registry;
+	}
+};
+
+inline ThreadCounters& LocalCounters(){
+	thread_local std::shared_ptr<ThreadCounters> counters = [](){
+		auto threadCounters = std::make_shared<ThreadCounters>();
+		Registry& registry = Registry::Get();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		registry.threads.push_back(threadCounters);
+		return threadCounters;
+	}();
+	return *counters;
+}
+
+inline void AppendJsonString(std::string& output, std::string_view text){
+	output += '"';
+	for(char ch : text){
+		if(ch == '"' || ch == '\\'){
+			output += '\\';
+			output += ch;
+		}
+		else if(static_cast<unsigned char>(ch) < 0x20){
+			char escaped[8];
+			std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(ch));
+			output += escaped;
+		}
+		else{
+			output += ch;
+		}
+	}
+	output += '"';
+}
+}
+
+/**
+ * Measures duration of scope and records it as one call of operation over property name.
+ **/
+class Scope{
+public: // functions
+	/**
+	 * @param site id of call site from detail::NextCallSite, kept in static variable of the site (see NAP_INSTRUMENT_SCOPE).
+	 **/
+	Scope(std::size_t site, Operation operation, std::string_view name) :
+	m_counters(detail::LocalCounters().find(site, operation, name)),
+	m_start(std::chrono::steady_clock::now())
+	{}
+	Scope(const Scope&) = delete;
+	Scope& operator=(const Scope&) = delete;
+	~Scope(){
+		auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start);
+		m_counters.record(static_cast<std::uint64_t>(elapsed.count()));
+	}
+
+private: // members
+	detail::OperationCounters& m_counters;
+	std::chrono::steady_clock::time_point m_start;
+};
+
+/**
+ * Adds bytes transferred by operation over property name, e.g. size of value written into archive.
+ * Only BinaryWriter (as Read of property) and BinaryReader (as Write) report bytes, other visitors leave them 0.
+ **/
+inline void AddBytes(std::size_t site, Operation operation, std::string_view name, std::uint64_t bytes){
+	detail::LocalCounters().find(site, operation, name).bytes.add(bytes);
+}
+
+/**
+ * Aggregates counters of all threads per property name.
+ * 
+ * @return stats of each property name which was instrumented, in unspecified order.
+ **/
+inline std::vector<PropertyStats> Collect(){
+	std::vector<PropertyStats> stats;
+	std::unordered_map<std::string_view, std::size_t> indices;
+	detail::Registry& registry = detail::Registry::Get();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	for(const auto& threadCounters : registry.threads){
+		threadCounters->forEach(
+			[&stats, &indices](const detail::PropertyCounters& counters){
+				auto [itIndex, inserted] = indices.emplace(counters.name, stats.size());
+				if(inserted){
+					stats.push_back(PropertyStats{counters.name, {}});
+				}
+				PropertyStats& property = stats[itIndex->second];
+				for(std::size_t i = 0; i < operation_count; ++i){
+					counters.operations[i].collect(property.operations[i]);
+				}
+			}
+		);
+	}
+	return stats;
+}
+
+/**
+ * Zeroes counters of all threads.
+ **/
+inline void Reset(){
+	detail::Registry& registry = detail::Registry::Get();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	for(const auto& threadCounters : registry.threads){
+		threadCounters->forEach(
+			[](detail::PropertyCounters& counters){
+				for(detail::OperationCounters& operation : counters.operations){
+					operation.reset();
+				}
+			}
+		);
+	}
+}
+
+/**
+ * Builds json report of all instrumented properties:
+ *  [{"name": ..., "read": {"calls": ..., "ns": ..., "bytes": ..., "histogram": [...]}, "write": {...}, "visit": {...}}, ...]
+ * Histogram lists counts of log2 nanosecond buckets, trailing empty buckets are omitted.
+ **/
+inline std::string Report(){
+	static constexpr const char* operationNames[operation_count] = {"read", "write", "visit"};
+	std::string output = "[";
+	bool firstProperty = true;
+	for(const PropertyStats& property : Collect()){
+		output += firstProperty ? "\n  {\"name\": " : ",\n  {\"name\": ";
+		firstProperty = false;
+		detail::AppendJsonString(output, property.name);
+		for(std::size_t i = 0; i < operation_count; ++i){
+			const OperationStats& stats = property.operations[i];
+			output += ", \"";
+			output += operationNames[i];
+			output += "\": {\"calls\": " + std::to_string(stats.calls)
+				+ ", \"ns\": " + std::to_string(stats.nanoseconds)
+				+ ", \"bytes\": " + std::to_string(stats.bytes)
+				+ ", \"histogram\": [";
+			std::size_t used = histogram_buckets;
+			while(used > 0 && stats.histogram[used - 1] == 0){
+				--used;
+			}
+			for(std::size_t bucket = 0; bucket < used; ++bucket){
+				output += (bucket == 0 ? "" : ", ") + std::to_string(stats.histogram[bucket]);
+			}
+			output += "]}";
+		}
+		output += "}";
+	}
+	output += firstProperty ? "]\n" : "\n]\n";
+	return output;
+}
+}
+}
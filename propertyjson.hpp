@@ -0,0 +1,962 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#pragma once
+#include "property.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace nap{
+
+/**
+ * Json sink appending output into std::string.
+ **/
+class JsonStringSink{
+public: // functions
+	JsonStringSink(std::string& output) : m_output(output){}
+	void operator()(const char* data, std::size_t size){m_output.append(data, size);}
+
+private: // members
+	std::string& m_output;
+};
+
+/**
+ * Json sink writing output into FILE*.
+ **/
+class JsonFileSink{
+public: // functions
+	JsonFileSink(std::FILE* file) : m_file(file){}
+	void operator()(const char* data, std::size_t size){
+		if(std::fwrite(data, 1, size, m_file) != size){
+			m_failed = true;
+		}
+	}
+	bool failed() const{return m_failed;}
+
+private: // members
+	std::FILE* m_file;
+	bool m_failed = false;
+};
+
+/**
+ * Json source reading FILE* in chunks, it seeks only when reader jumps back to key listed earlier than visited,
+ *  which needs seekable file (not a pipe).
+ **/
+class JsonFileSource{
+public: // functions
+	JsonFileSource(std::FILE* file) : m_file(file), m_start(std::ftell(file)){}
+	/**
+	 * Reads up to size bytes of the document at offset from position of file when source was created.
+	 * 
+	 * @return count of bytes read, 0 at the end of file or when seek failed.
+	 **/
+	std::size_t operator()(std::size_t offset, char* data, std::size_t size){
+		if(offset != m_offset){
+			if(m_start < 0 || std::fseek(m_file, m_start + static_cast<long>(offset), SEEK_SET) != 0){
+				m_failed = true;
+				return 0;
+			}
+			m_offset = offset;
+		}
+		std::size_t count = std::fread(data, 1, size, m_file);
+		m_offset += count;
+		return count;
+	}
+	bool failed() const{return m_failed;}
+
+private: // members
+	std::FILE* m_file;
+	long m_start;
+	std::size_t m_offset = 0;
+	bool m_failed = false;
+};
+
+namespace detail{
+
+/**
+ * Fixed size buffer in front of json sink, so output is flushed in chunks and memory stays bounded.
+ **/
+template<class Sink>
+class JsonOutput{
+public: // functions
+	JsonOutput(Sink& sink) : m_sink(sink){}
+	~JsonOutput(){flush();}
+
+	void put(char ch){
+		if(m_size == sizeof(m_buffer)){
+			flush();
+		}
+		m_buffer[m_size++] = ch;
+	}
+	void put(std::string_view text){
+		if(text.size() > sizeof(m_buffer) - m_size){
+			flush();
+			if(text.size() > sizeof(m_buffer)){
+				m_sink(text.data(), text.size());
+				return;
+			}
+		}
+		text.copy(m_buffer + m_size, text.size());
+		m_size += text.size();
+	}
+	void putString(std::string_view text){
+		static constexpr char hex[] = "0123456789abcdef";
+		put('"');
+		std::size_t plain = 0;
+		for(std::size_t i = 0; i < text.size(); ++i){
+			unsigned char ch = static_cast<unsigned char>(text[i]);
+			if(ch >= 0x20 && ch != '"' && ch != '\\'){
+				continue;
+			}
+			put(text.substr(plain, i - plain));
+			plain = i + 1;
+			switch(ch){
+				case '"':  put("\\\""); break;
+				case '\\': put("\\\\"); break;
+				case '\n': put("\\n"); break;
+				case '\r': put("\\r"); break;
+				case '\t': put("\\t"); break;
+				case '\b': put("\\b"); break;
+				case '\f': put("\\f"); break;
+				default:
+					put("\\u00");
+					put(hex[ch >> 4]);
+					put(hex[ch & 0xf]);
+			}
+		}
+		put(text.substr(plain));
+		put('"');
+	}
+	template<typename T>
+	void putNumber(T value){
+		if constexpr(std::is_floating_point_v<T>){
+			if(!std::isfinite(value)){
+				put("null");
+				return;
+			}
+		}
+		char digits[64];
+		auto result = std::to_chars(digits, digits + sizeof(digits), value);
+		put(std::string_view(digits, result.ptr - digits));
+	}
+	void flush(){
+		if(m_size != 0){
+			m_sink(m_buffer, m_size);
+			m_size = 0;
+		}
+	}
+
+private: // members
+	Sink& m_sink;
+	char m_buffer[4096];
+	std::size_t m_size = 0;
+};
+
+template<class Source>
+inline constexpr bool is_json_source_v = std::is_invocable_r_v<std::size_t, Source&, std::size_t, char*, std::size_t>;
+
+/**
+ * Pull tokenizer over json text, used by JsonReader without building any DOM.
+ * Text is either whole document in memory, or read from source through fixed size window,
+ *  positions are offsets from start of the document in both cases.
+ **/
+class JsonInput{
+public: // functions
+	JsonInput(std::string_view text) : m_text(text.data()), m_size(text.size()){}
+
+	template<class Source, typename = std::enable_if_t<is_json_source_v<Source>>>
+	/**
+	 * @param source functor std::size_t(std::size_t offset, char* data, std::size_t size) reading document at offset,
+	 *  it has to outlive the input.
+	 **/
+	JsonInput(Source& source) :
+	m_source(&source),
+	m_read(
+		[](void* source, std::size_t offset, char* data, std::size_t size) -> std::size_t{
+			return (*static_cast<Source*>(source))(offset, data, size);
+		}
+	)
+	{}
+
+	// window may point into input itself
+	JsonInput(const JsonInput& other){*this = other;}
+	JsonInput& operator=(const JsonInput& other){
+		m_source = other.m_source;
+		m_read = other.m_read;
+		if(other.m_read != nullptr){
+			std::memcpy(m_buffer, other.m_buffer, other.m_size);
+		}
+		m_text = (other.m_read != nullptr) ? m_buffer : other.m_text;
+		m_size = other.m_size;
+		m_base = other.m_base;
+		m_position = other.m_position;
+		m_token = other.m_token;
+		return *this;
+	}
+
+	/**
+	 * Skips whitespace and consumes expected character.
+	 * 
+	 * @return false when next character is different.
+	 **/
+	bool consume(char expected){
+		if(peek() != expected){
+			return false;
+		}
+		++m_position;
+		return true;
+	}
+	/**
+	 * @return next non-whitespace character, or 0 at the end of text.
+	 **/
+	char peek(){
+		while(m_position < m_size || fill()){
+			char ch = m_text[m_position];
+			if(ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r'){
+				return ch;
+			}
+			++m_position;
+		}
+		return 0;
+	}
+	/**
+	 * Reads string token, unescaping it into scratch only when it contains escapes or crosses the window.
+	 * 
+	 * @param output view of the string, pointing into text or into scratch, valid until next read.
+	 * 
+	 * @return false when string is malformed.
+	 **/
+	bool readString(std::string_view& output, std::string& scratch){
+		if(!consume('"')){
+			return false;
+		}
+		std::size_t start = m_position;
+		while(m_position < m_size){
+			char ch = m_text[m_position];
+			if(ch == '"'){
+				output = std::string_view(m_text + start, m_position - start);
+				++m_position;
+				return true;
+			}
+			if(ch == '\\'){
+				break;
+			}
+			++m_position;
+		}
+		scratch.assign(m_text + start, m_position - start);
+		return readEscaped(output, scratch);
+	}
+	/**
+	 * Reads number or literal token (true, false, null).
+	 * 
+	 * @return view of the token, valid until next read.
+	 **/
+	std::string_view readScalar(){
+		peek();
+		std::size_t start = m_position;
+		while(m_position < m_size){
+			if(isScalarEnd(m_text[m_position])){
+				return std::string_view(m_text + start, m_position - start);
+			}
+			++m_position;
+		}
+		// token continues past the window
+		m_token.assign(m_text + start, m_position - start);
+		while(fill()){
+			while(m_position < m_size){
+				if(isScalarEnd(m_text[m_position])){
+					return m_token;
+				}
+				m_token.push_back(m_text[m_position++]);
+			}
+		}
+		return m_token;
+	}
+	/**
+	 * Skips whole value including nested objects and arrays.
+	 **/
+	bool skipValue(std::string& scratch){
+		std::size_t depth = 0;
+		do{
+			char ch = peek();
+			std::string_view ignored;
+			if(ch == '{' || ch == '['){
+				++m_position;
+				++depth;
+			}
+			else if(ch == '}' || ch == ']'){
+				if(depth == 0){
+					return false;
+				}
+				++m_position;
+				--depth;
+			}
+			else if(ch == '"'){
+				if(!readString(ignored, scratch)){
+					return false;
+				}
+				if(depth != 0 && peek() == ':'){
+					++m_position;
+				}
+			}
+			else if(ch == ',' && depth != 0){
+				++m_position;
+			}
+			else if(ch == 0 || readScalar().empty()){
+				return false;
+			}
+		}while(depth != 0);
+		return true;
+	}
+
+	/**
+	 * @return offset of next character from start of the document.
+	 **/
+	std::size_t position() const{return m_base + m_position;}
+	/**
+	 * Moves to offset from start of the document, source is read again only when offset is outside of the window.
+	 **/
+	void seek(std::size_t position){
+		if(position >= m_base && position <= m_base + m_size){
+			m_position = position - m_base;
+			return;
+		}
+		// next read fills window from new position
+		m_base = position;
+		m_size = 0;
+		m_position = 0;
+	}
+
+private: // functions
+	/**
+	 * Reads next part of the document after current window.
+	 * 
+	 * @return false at the end of the document.
+	 **/
+	bool fill(){
+		if(m_read == nullptr){
+			return false;
+		}
+		m_base += m_size;
+		m_position = 0;
+		m_size = m_read(m_source, m_base, m_buffer, sizeof(m_buffer));
+		m_text = m_buffer;
+		return (m_size != 0);
+	}
+	bool get(char& ch){
+		if(m_position == m_size && !fill()){
+			return false;
+		}
+		ch = m_text[m_position++];
+		return true;
+	}
+	static bool isScalarEnd(char ch){
+		return (ch == ',' || ch == '}' || ch == ']' || ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r');
+	}
+	bool readEscaped(std::string_view& output, std::string& scratch){
+		char ch = 0;
+		while(get(ch)){
+			if(ch == '"'){
+				output = scratch;
+				return true;
+			}
+			if(ch != '\\'){
+				scratch.push_back(ch);
+				continue;
+			}
+			if(!get(ch)){
+				return false;
+			}
+			switch(ch){
+				case '"':  scratch.push_back('"'); break;
+				case '\\': scratch.push_back('\\'); break;
+				case '/':  scratch.push_back('/'); break;
+				case 'n':  scratch.push_back('\n'); break;
+				case 'r':  scratch.push_back('\r'); break;
+				case 't':  scratch.push_back('\t'); break;
+				case 'b':  scratch.push_back('\b'); break;
+				case 'f':  scratch.push_back('\f'); break;
+				case 'u':{
+					std::uint32_t codePoint = 0;
+					if(!readHex(codePoint)){
+						return false;
+					}
+					if(codePoint >= 0xd800 && codePoint < 0xdc00){
+						std::uint32_t low = 0;
+						char slash = 0;
+						char u = 0;
+						if(!get(slash) || !get(u) || slash != '\\' || u != 'u'){
+							return false;
+						}
+						if(!readHex(low) || low < 0xdc00 || low >= 0xe000){
+							return false;
+						}
+						codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+					}
+					appendUtf8(scratch, codePoint);
+					break;
+				}
+				default:
+					return false;
+			}
+		}
+		return false;
+	}
+	bool readHex(std::uint32_t& value){
+		char digits[4];
+		for(char& digit : digits){
+			if(!get(digit)){
+				return false;
+			}
+		}
+		auto result = std::from_chars(digits, digits + sizeof(digits), value, 16);
+		return (result.ptr == digits + sizeof(digits));
+	}
+	static void appendUtf8(std::string& output, std::uint32_t codePoint){
+		if(codePoint < 0x80){
+			output.push_back(static_cast<char>(codePoint));
+		}
+		else if(codePoint < 0x800){
+			output.push_back(static_cast<char>(0xc0 | (codePoint >> 6)));
+			output.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+		}
+		else if(codePoint < 0x10000){
+			output.push_back(static_cast<char>(0xe0 | (codePoint >> 12)));
+			output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+			output.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+		}
+		else{
+			output.push_back(static_cast<char>(0xf0 | (codePoint >> 18)));
+			output.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f)));
+			output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+			output.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+		}
+	}
+
+private: // members
+	const char* m_text = nullptr;        // current window
+	std::size_t m_size = 0;              // size of the window
+	std::size_t m_base = 0;              // offset of the window from start of the document
+	std::size_t m_position = 0;          // position within the window
+	void* m_source = nullptr;
+	std::size_t (*m_read)(void*, std::size_t, char*, std::size_t) = nullptr;
+	std::string m_token;                 // scalar token crossing the window
+	char m_buffer[4096];
+};
+
+template<typename T>
+/**
+ * Json representation of single value type, char is stored as one character string.
+ **/
+struct JsonCodec{
+	template<class Output>
+	static void Encode(Output& output, const T& value){
+		if constexpr(std::is_same_v<T, bool>){
+			output.put(value ? std::string_view("true") : std::string_view("false"));
+		}
+		else if constexpr(std::is_same_v<T, char>){
+			output.putString(std::string_view(&value, 1));
+		}
+		else if constexpr(std::is_arithmetic_v<T>){
+			output.putNumber(value);
+		}
+		else{
+			output.putString(std::string_view(value));
+		}
+	}
+	/**
+	 * Decodes value, strings are returned as std::string_view pointing into input or into scratch.
+	 **/
+	static bool Decode(JsonInput& input, T& value, std::string& scratch){
+		if constexpr(std::is_same_v<T, char>){
+			std::string_view text;
+			if(!input.readString(text, scratch) || text.size() != 1){
+				return false;
+			}
+			value = text[0];
+			return true;
+		}
+		else if constexpr(std::is_arithmetic_v<T>){
+			std::string_view text = input.readScalar();
+			if constexpr(std::is_same_v<T, bool>){
+				value = (text == "true");
+				return (value || text == "false");
+			}
+			else{
+				if constexpr(std::is_floating_point_v<T>){
+					if(text == "null"){
+						value = std::numeric_limits<T>::quiet_NaN();
+						return true;
+					}
+				}
+				auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+				return (result.ec == std::errc() && result.ptr == text.data() + text.size());
+			}
+		}
+		else{
+			return false;
+		}
+	}
+};
+
+template<class PropertyT, typename... Types>
+/**
+ * Tables of json codecs for Types, keyed by interface type key.
+ **/
+class JsonTypeTable{
+public: // type definitions
+	using any_type  = typename PropertyT::any_type;
+	using interface = typename PropertyT::interface;
+	using type_key  = typename interface::type_key;
+
+	template<class Sink>
+	using Encoder = void (*)(JsonOutput<Sink>& output, const any_type& value);
+	using Decoder = bool (*)(JsonInput& input, const PropertyT& property, std::string& scratch);
+
+public: // static functions
+	template<class Sink>
+	/**
+	 * @return encoder of type stored in value, or nullptr when type is not supported.
+	 **/
+	static Encoder<Sink> FindEncoder(const any_type& value){
+		// built once per property template and sink, so visiting does not allocate
+		static const std::unordered_map<type_key, Encoder<Sink>> table = [](){
+			std::unordered_map<type_key, Encoder<Sink>> entries;
+			(AddEncoder<Sink, Types>(entries), ...);
+			return entries;
+		}();
+		auto itEntry = table.find(interface::key_of(value));
+		return (itEntry != table.end()) ? itEntry->second : nullptr;
+	}
+	/**
+	 * @return decoder of type stored in value, or nullptr when type is not supported.
+	 **/
+	static Decoder FindDecoder(const any_type& value){
+		static const std::unordered_map<type_key, Decoder> table = [](){
+			std::unordered_map<type_key, Decoder> entries;
+			(AddDecoder<Types>(entries), ...);
+			return entries;
+		}();
+		auto itEntry = table.find(interface::key_of(value));
+		return (itEntry != table.end()) ? itEntry->second : nullptr;
+	}
+
+private: // static functions
+	// types which interface cannot hold are left out
+	template<class Sink, typename T>
+	static void AddEncoder(std::unordered_map<type_key, Encoder<Sink>>& entries){
+		if constexpr(interface_supports_v<interface, T>){
+			entries.emplace(interface::template key_of<T>(), &Encode<Sink, T>);
+		}
+	}
+	template<typename T>
+	static void AddDecoder(std::unordered_map<type_key, Decoder>& entries){
+		if constexpr(interface_supports_v<interface, T>){
+			entries.emplace(interface::template key_of<T>(), &Decode<T>);
+		}
+	}
+
+	template<class Sink, typename T>
+	static void Encode(JsonOutput<Sink>& output, const any_type& value){
+		JsonCodec<T>::Encode(output, interface::template cast_any<T>(value));
+	}
+
+	template<typename T>
+	static bool Decode(JsonInput& input, const PropertyT& property, std::string& scratch){
+		any_type value;
+		if constexpr(std::is_same_v<T, std::string>){
+			std::string_view text;
+			if(!input.readString(text, scratch)){
+				return false;
+			}
+			// copy assign from scratch, so member reuses its capacity
+			if(text.data() != scratch.data()){
+				scratch.assign(text);
+			}
+			value = interface::template make_any<const std::string&>(scratch);
+			property.write(value);
+		}
+		else if constexpr(std::is_same_v<T, std::string_view>){
+			// view would point into reader's window or scratch, which are reused by next read, so member is left unchanged
+			return input.skipValue(scratch);
+		}
+		else{
+			T decoded{};
+			if(!JsonCodec<T>::Decode(input, decoded, scratch)){
+				return false;
+			}
+			value = interface::template make_any<T&>(decoded);
+			property.write(value);
+		}
+		return true;
+	}
+};
+
+template<class PropertyT>
+/**
+ * std::string_view is not part of default types, it cannot be read back (see JsonTypeTable::Decode).
+ **/
+using DefaultJsonTypes = JsonTypeTable<PropertyT,
+	bool, char, signed char, unsigned char, short, unsigned short, int, unsigned int,
+	long, unsigned long, long long, unsigned long long, float, double, std::string
+>;
+}
+
+template<class PropertyT, class Sink, class TypeTable = detail::DefaultJsonTypes<PropertyT>>
+/**
+ * Visitor streaming properties as json object into sink, without any intermediate copies of values.
+ * Name only properties open nested object, which holds following properties until next name only property.
+ * Nested properties are written as nested object of their children.
+ * Properties which are not readable, or are of unsupported type are skipped.
+ * 
+ * Sink is functor with signature void(const char* data, std::size_t size), e.g. JsonFileSink or JsonStringSink,
+ *  output is passed to sink in chunks of bounded size.
+ * 
+ * Usage:
+ *   nap::JsonFileSink sink(file);
+ *   nap::JsonWriter<Property, nap::JsonFileSink> writer(sink);
+ *   object.propertiesFunc(Property::Visitor::Reference(writer));
+ *   writer.finish();
+ **/
+class JsonWriter{
+public: // functions
+	JsonWriter(Sink& sink) : m_output(sink){
+		m_output.put('{');
+	}
+
+	bool operator()(const PropertyT& property){
+		if(property.isNested()){
+			putKey(property.name());
+			m_output.put('{');
+			bool inCategory = std::exchange(m_inCategory, false);
+			m_first = true;
+			bool result = property.visitChildren(PropertyT::Visitor::Reference(*this));
+			if(m_inCategory){
+				m_output.put('}');
+			}
+			m_output.put('}');
+			m_inCategory = inCategory;
+			m_first = false;
+			return result;
+		}
+		if(property.isNameOnly()){
+			if(m_inCategory){
+				m_output.put('}');
+			}
+			putKey(property.name());
+			m_output.put('{');
+			m_inCategory = true;
+			m_first = true;
+			return true;
+		}
+		if(!property.isReadable()){
+			return true;
+		}
+
+		typename PropertyT::any_type value;
+		property.read(value);
+		if(auto encode = TypeTable::template FindEncoder<Sink>(value)){
+			putKey(property.name());
+			encode(m_output, value);
+		}
+		return true;
+	}
+	/**
+	 * Closes open objects and flushes output into sink, has to be called after all properties were visited.
+	 **/
+	void finish(){
+		if(m_inCategory){
+			m_output.put('}');
+			m_inCategory = false;
+		}
+		m_output.put('}');
+		m_output.flush();
+	}
+
+private: // functions
+	void putKey(std::string_view name){
+		if(!m_first){
+			m_output.put(',');
+		}
+		m_first = false;
+		m_output.putString(name);
+		m_output.put(':');
+	}
+
+private: // members
+	detail::JsonOutput<Sink> m_output;
+	bool m_inCategory = false;
+	bool m_first = true;
+};
+
+template<class PropertyT, class TypeTable = detail::DefaultJsonTypes<PropertyT>>
+/**
+ * SAX-style visitor reading json object written by JsonWriter, writing values directly into matching properties.
+ * Keys are matched against property names in order of visiting. When keys are in the same order (as JsonWriter writes them)
+ *  input is read once from start to end. Keys skipped while searching are indexed by hash of their name,
+ *  so keys listed earlier than visited are found by one seek and each member of object is scanned at most once.
+ * Properties without key in their object are left unchanged.
+ * Name only properties enter nested object of the same name, nested properties descend into it.
+ * 
+ * Input is either whole document in memory, or source read through fixed size window (e.g. JsonFileSource).
+ * Strings are written through one reused scratch string, no DOM or per value copies are made,
+ *  memory of the reader grows only with count of keys skipped in open objects.
+ **/
+class JsonReader{
+public: // functions
+	JsonReader(std::string_view text) : m_input(text){
+		open();
+	}
+	template<class Source, typename = std::enable_if_t<detail::is_json_source_v<Source>>>
+	/**
+	 * @param source functor std::size_t(std::size_t offset, char* data, std::size_t size), e.g. JsonFileSource,
+	 *  it has to outlive the reader.
+	 **/
+	JsonReader(Source& source) : m_input(source){
+		open();
+	}
+
+	/**
+	 * @return false when input is malformed or value does not match type of property, otherwise true.
+	 **/
+	bool operator()(const PropertyT& property){
+		if(m_failed){
+			return false;
+		}
+		if(property.isNested()){
+			if(!findKey(property.name())){
+				return !m_failed;
+			}
+			if(!openObject(false)){
+				return fail();
+			}
+			if(!property.visitChildren(PropertyT::Visitor::Reference(*this))){
+				return false;
+			}
+			if(m_frames[m_depth - 1].category && !closeObject()){
+				return fail();
+			}
+			return closeObject() || fail();
+		}
+		if(property.isNameOnly()){
+			if(m_frames[m_depth - 1].category && !closeObject()){
+				return fail();
+			}
+			if(findKey(property.name()) && !openObject(true)){
+				return fail();
+			}
+			return !m_failed;
+		}
+		if(!property.isReadable()){
+			return true;
+		}
+
+		// properties of unsupported types are not written by JsonWriter, so there is no key to look for
+		typename PropertyT::any_type value;
+		property.read(value);
+		typename TypeTable::Decoder decode = TypeTable::FindDecoder(value);
+		if(decode == nullptr){
+			return true;
+		}
+		if(!findKey(property.name())){
+			return !m_failed;
+		}
+		bool decoded = property.isWritable() ? decode(m_input, property, m_scratch) : m_input.skipValue(m_scratch);
+		if(!decoded){
+			return fail();
+		}
+		valueRead();
+		return true;
+	}
+	/**
+	 * Skips remaining keys and closes open objects.
+	 * 
+	 * @return true when whole input was read successfully.
+	 **/
+	bool finish(){
+		if(m_failed){
+			return false;
+		}
+		while(m_depth != 0){
+			if(!closeObject()){
+				return fail();
+			}
+		}
+		return true;
+	}
+
+private: // type definitions
+	/**
+	 * State of object which is being read.
+	 **/
+	struct Frame{
+		std::size_t frontier = 0;   // position after last scanned member, after closing bracket when closed
+		bool first = true;          // no member was scanned yet
+		bool closed = false;        // all members were scanned
+		bool category = false;      // object of name only property
+		bool pending = false;       // value of key found at frontier is being read
+		std::unordered_multimap<std::size_t, std::size_t> skipped; // hash of skipped key -> its position
+	};
+
+private: // functions
+	void open(){
+		m_failed = !m_input.consume('{');
+		pushFrame(false);
+	}
+	bool openObject(bool category){
+		if(!m_input.consume('{')){
+			return false;
+		}
+		pushFrame(category);
+		return true;
+	}
+	void pushFrame(bool category){
+		// frames are reused, so maps of skipped keys keep their buckets
+		if(m_depth == m_frames.size()){
+			m_frames.emplace_back();
+		}
+		Frame& frame = m_frames[m_depth++];
+		frame.frontier = m_input.position();
+		frame.first = true;
+		frame.closed = false;
+		frame.category = category;
+		frame.pending = false;
+		frame.skipped.clear();
+	}
+	/**
+	 * Moves frontier of current object after value which was just read, when its key was found at frontier.
+	 **/
+	void valueRead(){
+		Frame& frame = m_frames[m_depth - 1];
+		if(frame.pending){
+			frame.frontier = m_input.position();
+			frame.pending = false;
+		}
+	}
+	/**
+	 * Finds key in current object, first among keys skipped earlier, then by scanning members after frontier.
+	 * 
+	 * @return true when key was found and its value is next in input,
+	 *  false when object does not have the key or input is malformed (which also marks reader as failed).
+	 **/
+	bool findKey(std::string_view name){
+		Frame& frame = m_frames[m_depth - 1];
+		std::string_view key;
+		if(!frame.skipped.empty()){
+			auto range = frame.skipped.equal_range(std::hash<std::string_view>{}(name));
+			for(auto itKey = range.first; itKey != range.second; ++itKey){
+				m_input.seek(itKey->second);
+				if(!m_input.readString(key, m_scratch)){
+					return fail();
+				}
+				// key views window, which can be refilled by next read
+				bool found = (key == name);
+				if(!m_input.consume(':')){
+					return fail();
+				}
+				if(found){
+					return true;
+				}
+			}
+		}
+		if(frame.closed){
+			return false;
+		}
+		m_input.seek(frame.frontier);
+		while(m_input.peek() != '}'){
+			if(!frame.first && !m_input.consume(',')){
+				return fail();
+			}
+			std::size_t position = m_input.position();
+			if(!m_input.readString(key, m_scratch)){
+				return fail();
+			}
+			bool found = (key == name);
+			std::size_t hash = found ? 0 : std::hash<std::string_view>{}(key);
+			if(!m_input.consume(':')){
+				return fail();
+			}
+			frame.first = false;
+			if(found){
+				frame.pending = true;
+				return true;
+			}
+			frame.skipped.emplace(hash, position);
+			if(!m_input.skipValue(m_scratch)){
+				return fail();
+			}
+			frame.frontier = m_input.position();
+		}
+		m_input.consume('}');
+		frame.closed = true;
+		frame.frontier = m_input.position();
+		return false;
+	}
+	/**
+	 * Skips remaining members of current object and moves after its closing bracket.
+	 **/
+	bool closeObject(){
+		Frame& frame = m_frames[m_depth - 1];
+		if(!frame.closed){
+			m_input.seek(frame.frontier);
+			std::string_view key;
+			while(m_input.peek() != '}'){
+				if((!frame.first && !m_input.consume(',')) || !m_input.readString(key, m_scratch) || !m_input.consume(':') || !m_input.skipValue(m_scratch)){
+					return false;
+				}
+				frame.first = false;
+			}
+			m_input.consume('}');
+			frame.closed = true;
+			frame.frontier = m_input.position();
+		}
+		m_input.seek(frame.frontier);
+		--m_depth;
+		if(m_depth != 0){
+			valueRead();
+		}
+		return true;
+	}
+	bool fail(){
+		m_failed = true;
+		return false;
+	}
+
+private: // members
+	detail::JsonInput m_input;
+	std::string m_scratch;
+	std::vector<Frame> m_frames;
+	std::size_t m_depth = 0;
+	bool m_failed = false;
+};
+}
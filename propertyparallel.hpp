@@ -0,0 +1,320 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#pragma once
+#include "property.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace nap{
+
+/**
+ * Pool of worker threads for visiting large random access ranges (of properties, or of objects exposing properties).
+ * 
+ * Range is split into chunks, which are distributed between workers in contiguous blocks.
+ * Worker which runs out of its own chunks steals remaining chunks of other workers.
+ * When any visit returns false, remaining chunks are cancelled.
+ * 
+ * Chunking depends only on range size and chunk size (never on number of threads),
+ *  so reductions done in chunk order are deterministic.
+ * 
+ * Visit started from callable running on the same pool (e.g. nested ParallelVisit on DefaultVisitPool)
+ *  does not wait for the pool, which is busy with outer visit, its chunks are run inline by the calling thread.
+ * 
+ * @note Visiting callables are called concurrently and should not throw.
+ **/
+class VisitPool{
+public: // functions
+	/**
+	 * @param threads number of threads visiting range, including the calling thread,
+	 *  0 uses std::thread::hardware_concurrency().
+	 **/
+	explicit VisitPool(std::size_t threads = 0){
+		if(threads == 0){
+			threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+		}
+		m_blocks.reset(new Block[threads]);
+		m_size = threads;
+		for(std::size_t worker = 1; worker < threads; ++worker){
+			m_threads.emplace_back([this, worker](){workerLoop(worker);});
+		}
+	}
+	~VisitPool(){
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_wake.notify_all();
+		for(std::thread& thread : m_threads){
+			thread.join();
+		}
+	}
+	VisitPool(const VisitPool&) = delete;
+	VisitPool& operator=(const VisitPool&) = delete;
+
+	/**
+	 * @return number of threads visiting range, including the calling thread.
+	 **/
+	std::size_t size() const{return m_size;}
+
+	template<class Iterator, class Callable>
+	/**
+	 * Runs callable over each element of random access range in parallel.
+	 * 
+	 * @param callable functor with signature bool(const element&), called concurrently.
+	 * @param chunkSize number of elements visited by worker at once, 0 picks size based on range size.
+	 * 
+	 * @return true when all callable calls returned true, otherwise false
+	 * 
+	 * @note First call of callable which returns false cancels chunks which were not started yet.
+	 **/
+	bool visit(Iterator first, Iterator last, const Callable& callable, std::size_t chunkSize = 0){
+		const std::size_t count = static_cast<std::size_t>(std::distance(first, last));
+		chunkSize = ChunkSize(count, chunkSize);
+
+		auto visitChunk = [first, count, chunkSize, &callable, this](std::size_t chunk){
+			const std::size_t begin = chunk * chunkSize;
+			const std::size_t end = std::min(count, begin + chunkSize);
+			for(std::size_t i = begin; i < end; ++i){
+				if(callable(first[i]) == false){
+					return false;
+				}
+				if(m_cancelled.load(std::memory_order_relaxed)){
+					return false;
+				}
+			}
+			return true;
+		};
+		return execute((count + chunkSize - 1) / chunkSize, visitChunk);
+	}
+
+	template<class Iterator, class T, class Callable, class Reduce>
+	/**
+	 * Runs callable over each element of random access range in parallel, accumulating results per chunk.
+	 * Chunk results are then reduced in chunk order, so result does not depend on number of threads.
+	 * 
+	 * @param result initial value, which is reduced with results of all chunks when visiting succeeded.
+	 * @param callable functor with signature bool(const element&, T& chunkResult), chunkResult starts value initialized.
+	 * @param reduce functor with signature T(const T& result, const T& chunkResult).
+	 * @param chunkSize number of elements visited by worker at once, 0 picks size based on range size.
+	 * 
+	 * @return true when all callable calls returned true, otherwise false and result is left unchanged.
+	 **/
+	bool visitReduce(Iterator first, Iterator last, T& result, const Callable& callable, const Reduce& reduce, std::size_t chunkSize = 0){
+		const std::size_t count = static_cast<std::size_t>(std::distance(first, last));
+		chunkSize = ChunkSize(count, chunkSize);
+		std::vector<T> chunkResults((count + chunkSize - 1) / chunkSize);
+
+		auto visitChunk = [first, count, chunkSize, &callable, &chunkResults, this](std::size_t chunk){
+			const std::size_t begin = chunk * chunkSize;
+			const std::size_t end = std::min(count, begin + chunkSize);
+			T& chunkResult = chunkResults[chunk];
+			for(std::size_t i = begin; i < end; ++i){
+				if(callable(first[i], chunkResult) == false){
+					return false;
+				}
+				if(m_cancelled.load(std::memory_order_relaxed)){
+					return false;
+				}
+			}
+			return true;
+		};
+		if(!execute(chunkResults.size(), visitChunk)){
+			return false;
+		}
+		for(const T& chunkResult : chunkResults){
+			result = reduce(result, chunkResult);
+		}
+		return true;
+	}
+
+private: // type definitions
+	/**
+	 * Chunks owned by single worker, padded to avoid false sharing between workers.
+	 **/
+	struct alignas(64) Block{
+		std::atomic<std::size_t> next{0};
+		std::size_t end = 0;
+	};
+
+private: // static functions
+	static std::size_t ChunkSize(std::size_t count, std::size_t chunkSize){
+		if(chunkSize != 0){
+			return chunkSize;
+		}
+		// enough chunks for balancing, but not so many that claiming them dominates
+		return std::max<std::size_t>(64, count / 1024);
+	}
+
+private: // functions
+	bool execute(std::size_t chunkCount, detail::FunctionRef<bool(std::size_t)> visitChunk){
+		if(chunkCount == 0){
+			return true;
+		}
+		if(RunningPool == this){
+			for(std::size_t chunk = 0; chunk < chunkCount; ++chunk){
+				if(!visitChunk(chunk)){
+					return false;
+				}
+			}
+			return true;
+		}
+		std::lock_guard<std::mutex> executeLock(m_executeMutex);
+
+		const std::size_t blockSize = (chunkCount + m_size - 1) / m_size;
+		for(std::size_t worker = 0; worker < m_size; ++worker){
+			m_blocks[worker].next.store(std::min(chunkCount, worker * blockSize), std::memory_order_relaxed);
+			m_blocks[worker].end = std::min(chunkCount, (worker + 1) * blockSize);
+		}
+		m_cancelled.store(false, std::memory_order_relaxed);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_visitChunk = visitChunk;
+			m_running = m_size - 1;
+			++m_generation;
+		}
+		m_wake.notify_all();
+
+		const VisitPool* previous = std::exchange(RunningPool, this);
+		runWorker(0);
+		RunningPool = previous;
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done.wait(lock, [this](){return (m_running == 0);});
+		return !m_cancelled.load(std::memory_order_relaxed);
+	}
+
+	void workerLoop(std::size_t worker){
+		RunningPool = this;
+		std::size_t generation = 0;
+		for(;;){
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wake.wait(lock, [this, generation](){return (m_stop || m_generation != generation);});
+				if(m_stop){
+					return;
+				}
+				generation = m_generation;
+			}
+			runWorker(worker);
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				--m_running;
+			}
+			m_done.notify_one();
+		}
+	}
+
+	void runWorker(std::size_t worker){
+		// own block first, then steal from following workers
+		for(std::size_t offset = 0; offset < m_size; ++offset){
+			Block& block = m_blocks[(worker + offset) % m_size];
+			for(;;){
+				if(m_cancelled.load(std::memory_order_relaxed)){
+					return;
+				}
+				std::size_t chunk = block.next.fetch_add(1, std::memory_order_relaxed);
+				if(chunk >= block.end){
+					break;
+				}
+				if(!m_visitChunk(chunk)){
+					m_cancelled.store(true, std::memory_order_relaxed);
+					return;
+				}
+			}
+		}
+	}
+
+private: // static members
+	// pool whose chunks are run by current thread, to detect nested visit
+	static inline thread_local const VisitPool* RunningPool = nullptr;
+
+private: // members
+	std::size_t m_size = 1;
+	std::unique_ptr<Block[]> m_blocks;
+	std::vector<std::thread> m_threads;
+
+	std::mutex m_executeMutex;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	detail::FunctionRef<bool(std::size_t)> m_visitChunk;
+	std::size_t m_generation = 0;
+	std::size_t m_running = 0;
+	bool m_stop = false;
+	std::atomic<bool> m_cancelled{false};
+};
+
+/**
+ * @return pool shared by ParallelVisit calls, with one thread per hardware thread.
+ **/
+inline VisitPool& DefaultVisitPool(){
+	static VisitPool pool;
+	return pool;
+}
+
+template<class Iterator, class Callable>
+/**
+ * Runs callable over each element of random access range in parallel, using DefaultVisitPool.
+ * 
+ * @see VisitPool::visit
+ **/
+bool ParallelVisit(Iterator first, Iterator last, const Callable& callable, std::size_t chunkSize = 0){
+	return DefaultVisitPool().visit(first, last, callable, chunkSize);
+}
+
+template<class Callable, class PropertyArray>
+/**
+ * Parallel counterpart of PropertyTemplate::Visitor::visit, runs visitor over random access container of properties.
+ * 
+ * @param visitor visitor (or any type with bool visit(const property&) const), called concurrently.
+ * 
+ * @see VisitPool::visit
+ **/
+bool ParallelVisit(const Callable& visitor, const PropertyArray& properties, std::size_t chunkSize = 0){
+	return ParallelVisit(std::begin(properties), std::end(properties),
+		[&visitor](const auto& property){
+			return visitor.visit(property);
+		},
+		chunkSize
+	);
+}
+
+template<class Iterator, class T, class Callable, class Reduce>
+/**
+ * Runs callable over each element of random access range in parallel using DefaultVisitPool,
+ *  reducing per chunk results in chunk order.
+ * 
+ * @see VisitPool::visitReduce
+ **/
+bool ParallelVisitReduce(Iterator first, Iterator last, T& result, const Callable& callable, const Reduce& reduce, std::size_t chunkSize = 0){
+	return DefaultVisitPool().visitReduce(first, last, result, callable, reduce, chunkSize);
+}
+}
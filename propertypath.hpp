@@ -0,0 +1,149 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#pragma once
+#include "property.hpp"
+#include "propertyschema.hpp"
+
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace nap{
+
+namespace detail{
+
+/**
+ * Splits path at first '.' into its first segment and the rest.
+ **/
+inline std::pair<std::string_view, std::string_view> SplitPath(std::string_view path){
+	std::size_t separator = path.find('.');
+	if(separator == std::string_view::npos){
+		return {path, std::string_view()};
+	}
+	return {path.substr(0, separator), path.substr(separator + 1)};
+}
+
+template<class PropertyT>
+/**
+ * Visitor looking for property named by first segment of path among siblings,
+ *  descending only into nested property of matching name.
+ **/
+struct PathResolver{
+	bool operator()(const PropertyT& property){
+		if(property.name() != segment){
+			return true;
+		}
+		if(rest.empty()){
+			found = true;
+			result = visitor.visit(property);
+		}
+		else if(property.isNested()){
+			auto [childSegment, childRest] = SplitPath(rest);
+			PathResolver child{visitor, childSegment, childRest};
+			property.visitChildren(PropertyT::Visitor::Reference(child));
+			found = child.found;
+			result = child.result;
+		}
+		// siblings after match are not visited
+		return false;
+	}
+
+	const typename PropertyT::Visitor& visitor;
+	std::string_view segment;
+	std::string_view rest;
+	bool found = false;
+	bool result = false;
+};
+}
+
+template<class PropertyT, class PresentFunc>
+/**
+ * Runs visitor over single property addressed by path of names separated by '.' e.g. "transform.position.x".
+ * At each level siblings are only compared by name and only matching nested property is descended into,
+ *  so other subtrees are never materialized.
+ * 
+ * @param visitor visitor which will be called for found property.
+ * @param path names of nested properties and name of visited property, separated by '.'.
+ * @param present functor with signature void(const typename PropertyT::Visitor& visitor) presenting root properties,
+ *  e.g. [&object](const Property::Visitor& visitor){ object.propertiesFunc(visitor);}.
+ * 
+ * @return false when there is no such property, otherwise return value of visitor.
+ **/
+bool VisitPath(const typename PropertyT::Visitor& visitor, std::string_view path, const PresentFunc& present){
+	auto [segment, rest] = detail::SplitPath(path);
+	detail::PathResolver<PropertyT> resolver{visitor, segment, rest};
+	present(PropertyT::Visitor::Reference(resolver));
+	return resolver.found && resolver.result;
+}
+
+template<class Object, class Callable>
+/**
+ * Runs callable over single member addressed by path of schema field names separated by '.' e.g. "transform.position.x".
+ * Each level is resolved by perfect hash index of its schema, members of types which declare schema can be descended into.
+ * 
+ * @param callable functor with signature bool(std::string_view name, auto& member).
+ * 
+ * @return false when there is no such field, otherwise return value of callable.
+ **/
+bool VisitFieldPath(Object& object, std::string_view path, Callable&& callable){
+	auto [segment, rest] = detail::SplitPath(path);
+	constexpr const auto& schema = schema_of<Object>;
+	return schema.visitField(object, schema.indexOf(segment),
+		[rest = rest, &callable](std::string_view name, auto& member) -> bool{
+			if(rest.empty()){
+				return callable(name, member);
+			}
+			if constexpr(detail::has_schema_v<std::remove_reference_t<decltype(member)>>){
+				return VisitFieldPath(member, rest, callable);
+			}
+			else{
+				return false;
+			}
+		}
+	);
+}
+
+template<class PropertyT, class Object>
+/**
+ * Runs property visitor over single member addressed by path of schema field names.
+ * 
+ * @see VisitFieldPath
+ **/
+bool VisitPropertyPath(const typename PropertyT::Visitor& visitor, Object& object, std::string_view path){
+	auto [segment, rest] = detail::SplitPath(path);
+	constexpr const auto& schema = schema_of<Object>;
+	if(rest.empty()){
+		return schema.template visitProperty<PropertyT>(visitor, object, schema.indexOf(segment));
+	}
+	return schema.visitField(object, schema.indexOf(segment),
+		[rest = rest, &visitor](std::string_view, auto& member) -> bool{
+			if constexpr(detail::has_schema_v<std::remove_reference_t<decltype(member)>>){
+				return VisitPropertyPath<PropertyT>(visitor, member, rest);
+			}
+			else{
+				return false;
+			}
+		}
+	);
+}
+}
@@ -0,0 +1,518 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#pragma once
+#include "property.hpp"
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace nap{
+
+/**
+ * Precomputed 64-bit FNV-1a hash of property name, usable for lookups without hashing name again.
+ * Name is kept as view, in case schema had to hash its names with other seed, so it has to outlive the hash
+ *  (e.g. string literal).
+ **/
+struct NameHash{
+	static constexpr std::uint64_t DefaultSeed = 0xcbf29ce484222325ull;
+
+	constexpr explicit NameHash(std::string_view hashedName) : name(hashedName), value(Compute(hashedName)){}
+
+	/**
+	 * @param seed initial value of hash, other than DefaultSeed only for schemas which names collide with it.
+	 **/
+	static constexpr std::uint64_t Compute(std::string_view name, std::uint64_t seed = DefaultSeed){
+		std::uint64_t hash = seed;
+		for(char ch : name){
+			hash ^= static_cast<unsigned char>(ch);
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	std::string_view name;
+	std::uint64_t value;
+};
+
+namespace detail{
+
+template<std::size_t Size>
+/**
+ * Perfect hash index over names, built by hash and displace:
+ *  names are grouped to buckets by their hash and each bucket gets displacement
+ *  which maps all of its names into free slots, so lookup is one bucket read and one slot read.
+ **/
+class NameIndex{
+public: // static members
+	static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+	static constexpr std::size_t capacity = [](){
+		std::size_t result = 1;
+		while(result < Size){
+			result <<= 1;
+		}
+		return result;
+	}();
+
+public: // functions
+	constexpr NameIndex(const std::array<std::string_view, Size>& names){
+		std::array<std::uint64_t, Size> hashes{};
+		// distinct names with equal hashes are hashed again with other seed
+		for(std::size_t attempt = 1; !HashNames(names, m_seed, hashes); ++attempt){
+			if(attempt == 64){
+				throw "nap::Schema: could not hash field names without collision";
+			}
+			m_seed = NameHash::DefaultSeed + attempt * 0x9e3779b97f4a7c15ull;
+		}
+
+		// group names by bucket
+		std::array<std::size_t, capacity + 1> bucketStart{};
+		std::array<std::size_t, Size> members{};
+		for(std::size_t i = 0; i < Size; ++i){
+			++bucketStart[(hashes[i] & mask) + 1];
+		}
+		for(std::size_t i = 0; i < capacity; ++i){
+			bucketStart[i + 1] += bucketStart[i];
+		}
+		std::array<std::size_t, capacity> filled{};
+		for(std::size_t i = 0; i < Size; ++i){
+			std::size_t bucket = hashes[i] & mask;
+			members[bucketStart[bucket] + filled[bucket]++] = i;
+		}
+
+		// place biggest buckets first, while most of slots are still free
+		std::array<std::size_t, capacity> bucketOrder{};
+		for(std::size_t i = 0; i < capacity; ++i){
+			bucketOrder[i] = i;
+		}
+		for(std::size_t i = 1; i < capacity; ++i){
+			std::size_t bucket = bucketOrder[i];
+			std::size_t j = i;
+			for(; j > 0 && filled[bucketOrder[j - 1]] < filled[bucket]; --j){
+				bucketOrder[j] = bucketOrder[j - 1];
+			}
+			bucketOrder[j] = bucket;
+		}
+
+		for(std::size_t bucket : bucketOrder){
+			if(filled[bucket] == 0){
+				break;
+			}
+			std::uint64_t displacement = 1;
+			while(!tryPlace(hashes, members, bucketStart[bucket], bucketStart[bucket + 1], displacement)){
+				if(++displacement == (1ull << 24)){
+					throw "nap::Schema: could not build name index";
+				}
+			}
+			m_displacements[bucket] = displacement;
+		}
+	}
+
+	/**
+	 * @param hash precomputed name hash.
+	 * 
+	 * @return index of name with given hash, or npos when there is no such name.
+	 **/
+	constexpr std::size_t find(std::uint64_t hash) const{
+		std::size_t slot = Slot(hash, m_displacements[hash & mask]);
+		if(m_slots[slot] != 0 && m_hashes[slot] == hash){
+			return m_slots[slot] - 1;
+		}
+		return npos;
+	}
+	/**
+	 * @return seed which names are hashed with, NameHash::DefaultSeed unless names collided with it.
+	 **/
+	constexpr std::uint64_t seed() const{return m_seed;}
+
+private: // static functions
+	static constexpr std::uint64_t mask = capacity - 1;
+
+	/**
+	 * Hashes names with seed, names are compared when their hashes are equal.
+	 * 
+	 * @return false when distinct names have equal hashes.
+	 **/
+	static constexpr bool HashNames(const std::array<std::string_view, Size>& names, std::uint64_t seed, std::array<std::uint64_t, Size>& hashes){
+		for(std::size_t i = 0; i < Size; ++i){
+			hashes[i] = NameHash::Compute(names[i], seed);
+			for(std::size_t j = 0; j < i; ++j){
+				if(hashes[j] == hashes[i]){
+					if(names[j] == names[i]){
+						throw "nap::Schema: duplicate field name";
+					}
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	static constexpr std::size_t Slot(std::uint64_t hash, std::uint64_t displacement){
+		hash ^= displacement * 0x9e3779b97f4a7c15ull;
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdull;
+		hash ^= hash >> 33;
+		return static_cast<std::size_t>(hash & mask);
+	}
+
+private: // functions
+	constexpr bool tryPlace(const std::array<std::uint64_t, Size>& hashes, const std::array<std::size_t, Size>& members,
+		std::size_t first, std::size_t last, std::uint64_t displacement){
+		for(std::size_t i = first; i < last; ++i){
+			std::size_t name = members[i];
+			std::size_t slot = Slot(hashes[name], displacement);
+			if(m_slots[slot] != 0){
+				// slot taken, revert what was placed for this bucket
+				for(std::size_t j = first; j < i; ++j){
+					m_slots[Slot(hashes[members[j]], displacement)] = 0;
+				}
+				return false;
+			}
+			m_slots[slot] = name + 1;
+			m_hashes[slot] = hashes[name];
+		}
+		return true;
+	}
+
+private: // members
+	std::uint64_t m_seed = NameHash::DefaultSeed;
+	std::array<std::uint64_t, capacity> m_displacements{};
+	std::array<std::uint64_t, capacity> m_hashes{};
+	std::array<std::size_t, capacity> m_slots{}; // name index + 1, 0 when slot is empty
+};
+
+template<class T, class = void>
+struct has_schema : std::false_type{};
+template<class T>
+struct has_schema<T, std::void_t<decltype(T::propertySchema())>> : std::true_type{};
+
+/**
+ * Checks if T declares schema via static propertySchema().
+ **/
+template<class T>
+inline constexpr bool has_schema_v = has_schema<std::remove_const_t<T>>::value;
+
+template<class PropertyT, class Object>
+bool PresentSchema(Object& object, const typename PropertyT::Visitor& visitor);
+}
+
+/**
+ * Kind of constraint attached to field, for tooling inspecting schema.
+ **/
+enum class ConstraintKind{
+	None,
+	Range,
+	OneOf,
+	Length,
+	Predicate
+};
+
+/**
+ * Constraint of field without any restriction.
+ * 
+ * @see propertyconstraint.hpp for other constraints.
+ **/
+struct Unconstrained{
+	static constexpr ConstraintKind kind = ConstraintKind::None;
+
+	template<typename T>
+	constexpr bool operator()(const T&) const{return true;}
+};
+
+template<class Class, typename T, class Constraint = Unconstrained>
+/**
+ * Compile-time descriptor of named member, used as an entry of Schema.
+ * Optional constraint declares which values of member are valid, e.g.:
+ *   nap::Field("port", &Config::port, nap::constraint::Range(1, 65535))
+ **/
+struct Field{
+	using class_type      = Class;
+	using value_type      = T;
+	using constraint_type = Constraint;
+
+	constexpr Field(std::string_view fieldName, T Class::* fieldMember) : name(fieldName), member(fieldMember), constraint(){}
+	constexpr Field(std::string_view fieldName, T Class::* fieldMember, Constraint fieldConstraint) 
+		: name(fieldName), member(fieldMember), constraint(fieldConstraint){}
+
+	std::string_view name;
+	T Class::* member;
+	Constraint constraint;
+};
+
+template<class... Fields>
+/**
+ * Compile-time list of named members, declared once per class instead of
+ *  rebuilding initializer list of properties on every visit.
+ * 
+ * Class exposes its schema via static constexpr member function:
+ *   static constexpr auto propertySchema(){
+ *       return nap::Schema(nap::Field("x", &Point::x), nap::Field("y", &Point::y));
+ *   }
+ * 
+ * Fields are walked by fold expression, so each member access and type dispatch can be inlined.
+ **/
+class Schema{
+public: // static members
+	static constexpr std::size_t size = sizeof...(Fields);
+	static constexpr std::size_t npos = detail::NameIndex<size>::npos;
+
+public: // functions
+	constexpr Schema(Fields... fields) : m_fields(fields...), m_names{fields.name...}, m_index(m_names){}
+
+	template<class Object, class Callable>
+	/**
+	 * Runs callable over each field of object, in order of declaration.
+	 * 
+	 * @param object object which members will be passed to callable, const object passes const members.
+	 * @param callable functor with signature bool(std::string_view name, auto& member).
+	 * 
+	 * @return true when all callable calls returned true, otherwise false
+	 * 
+	 * @note First call of callable which returns false will also break the loop.
+	 **/
+	constexpr bool visit(Object& object, Callable&& callable) const{
+		return std::apply(
+			[&object, &callable](const auto&... field){
+				return (callable(field.name, object.*(field.member)) && ...);
+			},
+			m_fields
+		);
+	}
+
+	template<class PropertyT, class Object, class Callable, typename = detail::enable_if_visitor_t<Callable, PropertyT>>
+	/**
+	 * Runs property visitor over each field of object, constructing property only for the visited field.
+	 * Members which declare schema themselves are presented as nested properties.
+	 * 
+	 * @param visitor property visitor, or any callable bool(const PropertyT&) which is called directly,
+	 *  so fields, property construction and visitor body are all specialized together.
+	 * @param object object which members will be presented as properties, const object presents read only properties.
+	 * 
+	 * @return true when all visitor calls returned true, otherwise false
+	 **/
+	bool visitProperties(Callable&& visitor, Object& object) const{
+		return visit(object, 
+			[&visitor](std::string_view name, auto& member){
+				return detail::InvokeVisitor(visitor, MakeProperty<PropertyT>(name, member));
+			}
+		);
+	}
+
+	/**
+	 * Finds field by name in constant time, using perfect hash index built with schema.
+	 * 
+	 * @param name field name.
+	 * 
+	 * @return index of field, or npos when schema has no such field.
+	 **/
+	constexpr std::size_t indexOf(std::string_view name) const{
+		std::size_t index = m_index.find(NameHash::Compute(name, m_index.seed()));
+		if(index != npos && m_names[index] == name){
+			return index;
+		}
+		return npos;
+	}
+	/**
+	 * Finds field by precomputed name hash in constant time.
+	 * 
+	 * @param hash precomputed hash of field name.
+	 * 
+	 * @return index of field, or npos when schema has no such field.
+	 **/
+	constexpr std::size_t indexOf(NameHash hash) const{
+		if(m_index.seed() != NameHash::DefaultSeed){
+			return indexOf(hash.name);
+		}
+		return m_index.find(hash.value);
+	}
+
+	template<class Object, class Callable>
+	/**
+	 * Runs callable over single field of object, selected by index.
+	 * 
+	 * @param object object which member will be passed to callable.
+	 * @param index index of field e.g. from indexOf.
+	 * @param callable functor with signature bool(std::string_view name, auto& member).
+	 * 
+	 * @return false when index is out of range, otherwise return value of callable.
+	 **/
+	bool visitField(Object& object, std::size_t index, Callable&& callable) const{
+		return visitFieldImpl(object, index, callable, std::index_sequence_for<Fields...>{});
+	}
+
+	template<class PropertyT, class Object, class Callable, typename = detail::enable_if_visitor_t<Callable, PropertyT>>
+	/**
+	 * Runs property visitor (or any callable bool(const PropertyT&)) over single field of object, selected by index.
+	 * 
+	 * @return false when index is out of range, otherwise return value of visitor.
+	 **/
+	bool visitProperty(Callable&& visitor, Object& object, std::size_t index) const{
+		return visitField(object, index,
+			[&visitor](std::string_view name, auto& member){
+				return detail::InvokeVisitor(visitor, MakeProperty<PropertyT>(name, member));
+			}
+		);
+	}
+
+	template<class T, class Class>
+	/**
+	 * Finds member pointer of field at index, when field is member of Class with exactly type T.
+	 * 
+	 * @return member pointer, or nullptr when index is out of range or field has different type.
+	 **/
+	constexpr T Class::* memberOf(std::size_t index) const{
+		T Class::* result = nullptr;
+		std::size_t current = 0;
+		std::apply(
+			[&result, &current, index](const auto&... field){
+				((current++ == index ? void(result = MemberIf<T, Class>(field.member)) : void()), ...);
+			},
+			m_fields
+		);
+		return result;
+	}
+
+	template<std::size_t Index>
+	/**
+	 * @return field descriptor at Index.
+	 **/
+	constexpr const auto& field() const{return std::get<Index>(m_fields);}
+	/**
+	 * @return name of field at index.
+	 **/
+	constexpr std::string_view name(std::size_t index) const{return m_names[index];}
+
+private: // static functions
+	template<class PropertyT, class Member>
+	/**
+	 * @return property of member, nested property when member declares schema.
+	 **/
+	static PropertyT MakeProperty(std::string_view name, Member& member){
+		if constexpr(detail::has_schema_v<Member>){
+			return PropertyT::template Nested<&detail::PresentSchema<PropertyT, Member>>(name, member);
+		}
+		else{
+			return PropertyT(name, member);
+		}
+	}
+
+	template<class T, class Class, class Member>
+	static constexpr T Class::* MemberIf(Member member){
+		if constexpr(std::is_same_v<Member, T Class::*>){
+			return member;
+		}
+		else{
+			return nullptr;
+		}
+	}
+
+private: // functions
+	template<std::size_t Index, class Object, class Callable>
+	static bool InvokeField(const Schema& schema, Object& object, Callable& callable){
+		const auto& field = std::get<Index>(schema.m_fields);
+		return callable(field.name, object.*(field.member));
+	}
+
+	template<class Object, class Callable, std::size_t... Indices>
+	bool visitFieldImpl(Object& object, std::size_t index, Callable& callable, std::index_sequence<Indices...>) const{
+		if constexpr(size == 0){
+			return false;
+		}
+		else{
+			using Invoker = bool(*)(const Schema&, Object&, Callable&);
+			static constexpr Invoker invokers[] = {&InvokeField<Indices, Object, Callable>...};
+			return (index < size) && invokers[index](*this, object, callable);
+		}
+	}
+
+private: // members
+	std::tuple<Fields...> m_fields;
+	std::array<std::string_view, size> m_names;
+	detail::NameIndex<size> m_index;
+};
+
+template<class Object>
+/**
+ * Schema of Object, evaluated once at compile time from Object::propertySchema().
+ **/
+inline constexpr auto schema_of = std::remove_const_t<Object>::propertySchema();
+
+namespace detail{
+template<class Object>
+using schema_type = std::remove_const_t<decltype(schema_of<Object>)>;
+
+template<class PropertyT, class Object>
+/**
+ * Presents schema fields of object as properties, used as children of nested property.
+ **/
+bool PresentSchema(Object& object, const typename PropertyT::Visitor& visitor){
+	return schema_of<Object>.template visitProperties<PropertyT>(visitor, object);
+}
+}
+
+template<class Object, class Callable>
+/**
+ * Runs callable over each field of object schema.
+ * 
+ * @see Schema::visit
+ **/
+constexpr bool VisitFields(Object& object, Callable&& callable){
+	return schema_of<Object>.visit(object, std::forward<Callable>(callable));
+}
+
+template<class PropertyT, class Object, class Callable, typename = detail::enable_if_visitor_t<Callable, PropertyT>>
+/**
+ * Runs property visitor over each field of object schema.
+ * 
+ * @see Schema::visitProperties
+ **/
+bool VisitProperties(Callable&& visitor, Object& object){
+	return schema_of<Object>.template visitProperties<PropertyT>(std::forward<Callable>(visitor), object);
+}
+
+template<class Object, class Name, class Callable>
+/**
+ * Runs callable over single field of object schema, found by name or precomputed NameHash without linear scan.
+ * 
+ * @return false when there is no such field, otherwise return value of callable.
+ **/
+bool VisitField(Object& object, Name name, Callable&& callable){
+	constexpr const auto& schema = schema_of<Object>;
+	return schema.visitField(object, schema.indexOf(name), std::forward<Callable>(callable));
+}
+
+template<class PropertyT, class Object, class Name, class Callable, typename = detail::enable_if_visitor_t<Callable, PropertyT>>
+/**
+ * Runs property visitor over single field of object schema, found by name or precomputed NameHash without linear scan.
+ * 
+ * @return false when there is no such field, otherwise return value of visitor.
+ **/
+bool VisitProperty(Callable&& visitor, Object& object, Name name){
+	constexpr const auto& schema = schema_of<Object>;
+	return schema.template visitProperty<PropertyT>(std::forward<Callable>(visitor), object, schema.indexOf(name));
+}
+}
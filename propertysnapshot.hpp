@@ -0,0 +1,530 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#pragma once
+#include "property.hpp"
+#include "propertybinary.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NAP_SNAPSHOT_MMAP 1
+#endif
+
+namespace nap{
+
+namespace detail{
+
+/**
+ * Header at the beginning of snapshot file, all offsets are from the beginning of file.
+ * Values are stored in host representation, endianness field is used to reject snapshots of other hosts.
+ **/
+struct SnapshotHeader{
+	char magic[4];
+	std::uint32_t endianness;
+	std::uint64_t schemaHash;
+	std::uint64_t objectCount;
+	std::uint64_t fieldCount;
+	std::uint64_t recordSize;
+	std::uint64_t fieldsOffset;
+	std::uint64_t recordsOffset;
+	std::uint64_t poolOffset;
+	std::uint64_t poolSize;
+};
+
+/**
+ * Layout of single field in each record, name is stored in string pool.
+ **/
+struct SnapshotField{
+	std::uint64_t nameOffset;
+	std::uint32_t nameSize;
+	std::uint32_t offset;
+	std::uint8_t tag;
+	std::uint8_t reserved[7];
+};
+
+/**
+ * Slot of string value in record, characters are stored in string pool.
+ **/
+struct SnapshotString{
+	std::uint64_t offset;
+	std::uint64_t size;
+};
+
+inline constexpr char snapshot_magic[4] = {'N', 'A', 'P', 'S'};
+inline constexpr std::uint32_t snapshot_endianness = 0x01020304;
+inline constexpr std::size_t snapshot_alignment = 64;
+
+inline std::size_t AlignUp(std::size_t value, std::size_t alignment){
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * Read only mapping of whole file, via mmap on POSIX systems, otherwise file is read into memory.
+ **/
+class MappedFile{
+public: // functions
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile(){close();}
+
+	bool open(const char* path){
+		close();
+#ifdef NAP_SNAPSHOT_MMAP
+		int file = ::open(path, O_RDONLY);
+		if(file < 0){
+			return false;
+		}
+		struct stat status;
+		if(::fstat(file, &status) != 0 || status.st_size <= 0){
+			::close(file);
+			return false;
+		}
+		void* mapping = ::mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		::close(file);
+		if(mapping == MAP_FAILED){
+			return false;
+		}
+		m_data = static_cast<const char*>(mapping);
+		m_size = static_cast<std::size_t>(status.st_size);
+		return true;
+#else
+		std::FILE* file = std::fopen(path, "rb");
+		if(file == nullptr){
+			return false;
+		}
+		std::vector<char> buffer;
+		char chunk[64 * 1024];
+		for(std::size_t read; (read = std::fread(chunk, 1, sizeof(chunk), file)) != 0;){
+			buffer.insert(buffer.end(), chunk, chunk + read);
+		}
+		std::fclose(file);
+		m_buffer.swap(buffer);
+		m_data = m_buffer.data();
+		m_size = m_buffer.size();
+		return (m_size != 0);
+#endif
+	}
+	void close(){
+#ifdef NAP_SNAPSHOT_MMAP
+		if(m_data != nullptr){
+			::munmap(const_cast<char*>(m_data), m_size);
+		}
+#else
+		m_buffer.clear();
+#endif
+		m_data = nullptr;
+		m_size = 0;
+	}
+
+	const char* data() const{return m_data;}
+	std::size_t size() const{return m_size;}
+
+private: // members
+	const char* m_data = nullptr;
+	std::size_t m_size = 0;
+#ifndef NAP_SNAPSHOT_MMAP
+	std::vector<char> m_buffer;
+#endif
+};
+
+template<class PropertyT, typename... Types>
+/**
+ * Table of snapshot layouts for Types, keyed by interface type key.
+ * Tag of type is its position in Types + 1 as in BinaryTypeTable, so with the same type list
+ *  snapshot schema hash equals BinarySchemaHash of objects it was made from.
+ * Arithmetic types are stored in host representation at their natural alignment,
+ *  strings as SnapshotString and loaded as std::string_view.
+ **/
+class SnapshotTypeTable{
+public: // type definitions
+	using any_type  = typename PropertyT::any_type;
+	using interface = typename PropertyT::interface;
+	using Visitor   = typename PropertyT::Visitor;
+
+	struct Entry{
+		std::uint8_t tag;
+		std::size_t size;
+		std::size_t alignment;
+		void (*store)(char* slot, const any_type& value, std::string& pool);
+	};
+
+public: // static functions
+	/**
+	 * @return layout entry of type stored in value, or nullptr when type is not supported.
+	 **/
+	static const Entry* Find(const any_type& value){
+		static const std::unordered_map<typename interface::type_key, Entry> table = MakeTable(std::index_sequence_for<Types...>{});
+		auto itEntry = table.find(interface::key_of(value));
+		return (itEntry != table.end()) ? &itEntry->second : nullptr;
+	}
+	/**
+	 * @return size of slot of type with tag, or 0 when tag is unknown.
+	 **/
+	static std::size_t SlotSize(std::uint8_t tag){
+		static constexpr std::size_t sizes[] = {SlotSizeOf<Types>()...};
+		return (tag != 0 && tag <= sizeof...(Types)) ? sizes[tag - 1] : 0;
+	}
+	/**
+	 * @return alignment of slot of type with tag, or 0 when tag is unknown.
+	 **/
+	static std::size_t SlotAlignment(std::uint8_t tag){
+		static constexpr std::size_t alignments[] = {SlotAlignmentOf<Types>()...};
+		return (tag != 0 && tag <= sizeof...(Types)) ? alignments[tag - 1] : 0;
+	}
+	/**
+	 * Presents value in slot as read only property pointing into slot.
+	 * 
+	 * @return false when tag is unknown or string is out of pool, otherwise return value of visitor.
+	 **/
+	static bool Visit(std::uint8_t tag, const Visitor& visitor, std::string_view name, const char* slot, std::string_view pool){
+		using VisitFunction = bool (*)(const Visitor&, std::string_view, const char*, std::string_view);
+		static constexpr VisitFunction visits[] = {VisitSlotOf<Types>()...};
+		return (tag != 0 && tag <= sizeof...(Types)) && visits[tag - 1] != nullptr && visits[tag - 1](visitor, name, slot, pool);
+	}
+
+private: // static functions
+	template<typename T>
+	static constexpr bool is_string = std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>;
+
+	// strings are presented from slot as string_view, so interface has to hold both
+	template<typename T>
+	static constexpr bool is_supported = interface_supports_v<interface, T> && (!is_string<T> || interface_supports_v<interface, std::string_view>);
+
+	template<std::size_t... Indices>
+	static std::unordered_map<typename interface::type_key, Entry> MakeTable(std::index_sequence<Indices...>){
+		std::unordered_map<typename interface::type_key, Entry> table;
+		(AddEntry<Types>(table, Indices + 1), ...);
+		return table;
+	}
+	template<typename T>
+	static void AddEntry(std::unordered_map<typename interface::type_key, Entry>& table, std::size_t tag){
+		if constexpr(is_supported<T>){
+			table.emplace(interface::template key_of<T>(), MakeEntry<T>(tag));
+		}
+	}
+	template<typename T>
+	static constexpr bool (*VisitSlotOf())(const Visitor&, std::string_view, const char*, std::string_view){
+		if constexpr(is_supported<T>){
+			return &VisitSlot<T>;
+		}
+		else{
+			return nullptr;
+		}
+	}
+
+	template<typename T>
+	static constexpr std::size_t SlotSizeOf(){
+		static_assert(is_string<T> || std::is_trivially_copyable_v<T>, "snapshot types have to be trivially copyable or strings");
+		return is_string<T> ? sizeof(SnapshotString) : sizeof(T);
+	}
+	template<typename T>
+	static constexpr std::size_t SlotAlignmentOf(){
+		return is_string<T> ? alignof(SnapshotString) : alignof(T);
+	}
+	template<typename T>
+	static Entry MakeEntry(std::size_t tag){
+		return Entry{static_cast<std::uint8_t>(tag), SlotSizeOf<T>(), SlotAlignmentOf<T>(), &Store<T>};
+	}
+
+	template<typename T>
+	static void Store(char* slot, const any_type& value, std::string& pool){
+		const T& typed = interface::template cast_any<T>(value);
+		if constexpr(is_string<T>){
+			std::string_view string(typed);
+			SnapshotString stored{pool.size(), string.size()};
+			pool.append(string.data(), string.size());
+			std::memcpy(slot, &stored, sizeof(stored));
+		}
+		else{
+			std::memcpy(slot, &typed, sizeof(T));
+		}
+	}
+
+	template<typename T>
+	static bool VisitSlot(const Visitor& visitor, std::string_view name, const char* slot, std::string_view pool){
+		if constexpr(is_string<T>){
+			const SnapshotString& stored = *reinterpret_cast<const SnapshotString*>(slot);
+			if(stored.offset > pool.size() || stored.size > pool.size() - stored.offset){
+				return false;
+			}
+			const std::string_view string = pool.substr(static_cast<std::size_t>(stored.offset), static_cast<std::size_t>(stored.size));
+			return visitor.visit(PropertyT(name, PropertyT::ReadOnly(string)));
+		}
+		else{
+			return visitor.visit(PropertyT(name, PropertyT::ReadOnly(*reinterpret_cast<const T*>(slot))));
+		}
+	}
+};
+
+template<class PropertyT>
+using DefaultSnapshotTypes = SnapshotTypeTable<PropertyT,
+	bool, char, signed char, unsigned char, short, unsigned short, int, unsigned int,
+	long, unsigned long, long long, unsigned long long, float, double, std::string, std::string_view
+>;
+}
+
+template<class PropertyT, class TypeTable = detail::DefaultSnapshotTypes<PropertyT>>
+/**
+ * Visitor collecting properties of many objects into fixed record layout of snapshot file.
+ * Layout is taken from properties of the first object, each following object has to present properties of the same types.
+ * Name only properties, properties which are not readable and properties of unsupported types
+ *  do not store any value (unsupported types are still part of schema hash, as in BinaryWriter).
+ * Children of nested properties are stored in place of their parent, as in BinaryWriter.
+ * 
+ * Usage:
+ *   SnapshotWriter<Property> writer;
+ *   for(Object& object : objects){
+ *       object.propertiesFunc(Property::Visitor::Reference(writer));
+ *       writer.nextObject();
+ *   }
+ *   writer.save("objects.snapshot");
+ **/
+class SnapshotWriter{
+public: // functions
+	bool operator()(const PropertyT& property){
+		if(m_failed){
+			return false;
+		}
+		if(property.isNested()){
+			return property.visitChildren(PropertyT::Visitor::Reference(*this));
+		}
+		if(property.isNameOnly() || !property.isReadable()){
+			return true;
+		}
+		typename PropertyT::any_type value;
+		property.read(value);
+		const typename TypeTable::Entry* entry = TypeTable::Find(value);
+		if(m_objectCount == 0){
+			std::string_view name(property.name());
+			std::uint8_t tag = (entry != nullptr) ? entry->tag : 0;
+			m_hash = detail::HashBytes(m_hash, name.data(), name.size());
+			m_hash = detail::HashBytes(m_hash, &tag, sizeof(tag));
+			if(entry == nullptr){
+				return true;
+			}
+			detail::SnapshotField field{m_pool.size(), static_cast<std::uint32_t>(name.size()), 0, entry->tag, {}};
+			field.offset = static_cast<std::uint32_t>(detail::AlignUp(m_records.size(), entry->alignment));
+			m_pool.append(name.data(), name.size());
+			m_records.resize(field.offset + entry->size);
+			m_fields.push_back(field);
+		}
+		else if(entry == nullptr){
+			return true;
+		}
+		else if(m_field == 0){
+			m_records.resize(m_records.size() + m_recordSize);
+		}
+
+		if(m_field >= m_fields.size() || m_fields[m_field].tag != entry->tag){
+			m_failed = true;
+			return false;
+		}
+		char* record = m_records.data() + m_objectCount * m_recordSize;
+		entry->store(record + m_fields[m_field].offset, value, m_pool);
+		++m_field;
+		return true;
+	}
+	/**
+	 * Finishes record of current object, has to be called after all its properties were visited.
+	 * 
+	 * @return false when object did not present the same properties as the first one.
+	 **/
+	bool nextObject(){
+		if(m_failed || m_field != m_fields.size()){
+			m_failed = true;
+			return false;
+		}
+		if(m_objectCount == 0){
+			m_recordSize = detail::AlignUp(m_records.size(), alignof(std::uint64_t));
+			m_records.resize(m_recordSize);
+		}
+		else if(m_fields.empty()){
+			m_records.resize(m_records.size() + m_recordSize);
+		}
+		++m_objectCount;
+		m_field = 0;
+		return true;
+	}
+
+	/**
+	 * Writes snapshot into file.
+	 * 
+	 * @return false when some object did not match layout or file could not be written.
+	 **/
+	bool save(const char* path) const{
+		if(m_failed || m_field != 0){
+			return false;
+		}
+		std::FILE* file = std::fopen(path, "wb");
+		if(file == nullptr){
+			return false;
+		}
+		detail::SnapshotHeader header{};
+		std::memcpy(header.magic, detail::snapshot_magic, sizeof(header.magic));
+		header.endianness = detail::snapshot_endianness;
+		header.schemaHash = m_hash;
+		header.objectCount = m_objectCount;
+		header.fieldCount = m_fields.size();
+		header.recordSize = m_recordSize;
+		header.fieldsOffset = sizeof(header);
+		header.recordsOffset = detail::AlignUp(header.fieldsOffset + m_fields.size() * sizeof(detail::SnapshotField), detail::snapshot_alignment);
+		header.poolOffset = header.recordsOffset + m_objectCount * m_recordSize;
+		header.poolSize = m_pool.size();
+
+		const char padding[detail::snapshot_alignment] = {};
+		bool written = std::fwrite(&header, sizeof(header), 1, file) == 1;
+		written = written && (m_fields.empty() || std::fwrite(m_fields.data(), sizeof(detail::SnapshotField), m_fields.size(), file) == m_fields.size());
+		std::size_t paddingSize = header.recordsOffset - header.fieldsOffset - m_fields.size() * sizeof(detail::SnapshotField);
+		written = written && (paddingSize == 0 || std::fwrite(padding, 1, paddingSize, file) == paddingSize);
+		written = written && (m_records.empty() || std::fwrite(m_records.data(), 1, m_records.size(), file) == m_records.size());
+		written = written && (m_pool.empty() || std::fwrite(m_pool.data(), 1, m_pool.size(), file) == m_pool.size());
+		return (std::fclose(file) == 0) && written;
+	}
+
+	std::size_t objectCount() const{return m_objectCount;}
+	/**
+	 * @return schema hash of properties of the first object, equal to BinarySchemaHash of the object.
+	 **/
+	std::uint64_t schemaHash() const{return m_hash;}
+
+private: // members
+	std::vector<detail::SnapshotField> m_fields;
+	std::vector<char> m_records;
+	std::string m_pool;
+	std::size_t m_recordSize = 0;
+	std::size_t m_objectCount = 0;
+	std::size_t m_field = 0;
+	std::uint64_t m_hash = detail::hash_seed;
+	bool m_failed = false;
+};
+
+template<class PropertyT, class TypeTable = detail::DefaultSnapshotTypes<PropertyT>>
+/**
+ * Snapshot file mapped into memory, presenting objects as read only properties which read straight from the mapping.
+ * Nothing is deserialized on load, strings are presented as std::string_view into string pool of the file.
+ * 
+ * Usage:
+ *   Snapshot<Property> snapshot;
+ *   if(snapshot.open("objects.snapshot") && snapshot.schemaHash() == expectedHash){
+ *       snapshot.visit(visitor, objectIndex);
+ *   }
+ **/
+class Snapshot{
+public: // functions
+	/**
+	 * Maps snapshot file and validates its header and layout.
+	 * 
+	 * @return false when file could not be mapped or is not a valid snapshot of this host.
+	 **/
+	bool open(const char* path){
+		m_header = nullptr;
+		if(!m_file.open(path) || !validate()){
+			m_file.close();
+			return false;
+		}
+		return true;
+	}
+	void close(){
+		m_file.close();
+		m_header = nullptr;
+	}
+	bool isOpen() const{return (m_header != nullptr);}
+
+	/**
+	 * @return number of objects in snapshot.
+	 **/
+	std::size_t size() const{return isOpen() ? static_cast<std::size_t>(m_header->objectCount) : 0;}
+	std::size_t fieldCount() const{return isOpen() ? static_cast<std::size_t>(m_header->fieldCount) : 0;}
+	std::uint64_t schemaHash() const{return isOpen() ? m_header->schemaHash : 0;}
+
+	/**
+	 * Runs visitor over read only properties of object at index, each property is constructed only when visited.
+	 * 
+	 * @return false when index is out of range or any visitor call returned false, otherwise true.
+	 **/
+	bool visit(const typename PropertyT::Visitor& visitor, std::size_t index) const{
+		if(index >= size()){
+			return false;
+		}
+		const std::string_view pool(m_file.data() + m_header->poolOffset, static_cast<std::size_t>(m_header->poolSize));
+		const char* record = m_file.data() + m_header->recordsOffset + index * m_header->recordSize;
+		for(std::size_t i = 0; i < fieldCount(); ++i){
+			const detail::SnapshotField& field = m_fields[i];
+			std::string_view name = pool.substr(static_cast<std::size_t>(field.nameOffset), field.nameSize);
+			if(TypeTable::Visit(field.tag, visitor, name, record + field.offset, pool) == false){
+				return false;
+			}
+		}
+		return true;
+	}
+
+private: // functions
+	bool validate(){
+		const std::size_t fileSize = m_file.size();
+		if(fileSize < sizeof(detail::SnapshotHeader)){
+			return false;
+		}
+		const auto* header = reinterpret_cast<const detail::SnapshotHeader*>(m_file.data());
+		if(std::memcmp(header->magic, detail::snapshot_magic, sizeof(header->magic)) != 0 || header->endianness != detail::snapshot_endianness){
+			return false;
+		}
+		auto fits = [fileSize](std::uint64_t offset, std::uint64_t size){
+			return offset <= fileSize && size <= fileSize - offset;
+		};
+		if(header->fieldCount > fileSize / sizeof(detail::SnapshotField) || !fits(header->fieldsOffset, header->fieldCount * sizeof(detail::SnapshotField))
+			|| header->recordsOffset % detail::snapshot_alignment != 0 || header->recordSize % alignof(std::uint64_t) != 0
+			|| (header->recordSize != 0 && header->objectCount > fileSize / header->recordSize)
+			|| !fits(header->recordsOffset, header->objectCount * header->recordSize) || !fits(header->poolOffset, header->poolSize)){
+			return false;
+		}
+		m_fields = reinterpret_cast<const detail::SnapshotField*>(m_file.data() + header->fieldsOffset);
+		for(std::size_t i = 0; i < header->fieldCount; ++i){
+			const detail::SnapshotField& field = m_fields[i];
+			std::size_t slotSize = TypeTable::SlotSize(field.tag);
+			if(slotSize == 0 || field.offset + slotSize > header->recordSize || field.offset % TypeTable::SlotAlignment(field.tag) != 0
+				|| field.nameOffset > header->poolSize || field.nameSize > header->poolSize - field.nameOffset){
+				return false;
+			}
+		}
+		m_header = header;
+		return true;
+	}
+
+private: // members
+	detail::MappedFile m_file;
+	const detail::SnapshotHeader* m_header = nullptr;
+	const detail::SnapshotField* m_fields = nullptr;
+};
+}
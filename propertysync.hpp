@@ -0,0 +1,265 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#pragma once
+#include "property.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace nap{
+
+template<class T>
+/**
+ * Value guarded by sequence lock, for trivially copyable types.
+ * Readers never block writers, they retry copying value when it was written meanwhile,
+ *  writers are serialized between each other.
+ **/
+class SeqLocked{
+	static_assert(std::is_trivially_copyable_v<T>, "SeqLocked requires trivially copyable type");
+
+public: // type definitions
+	using value_type = T;
+
+public: // functions
+	SeqLocked() : SeqLocked(T{}){}
+	explicit SeqLocked(const T& value){storeWords(value);}
+	SeqLocked(const SeqLocked&) = delete;
+	SeqLocked& operator=(const SeqLocked&) = delete;
+
+	/**
+	 * @return consistent copy of value.
+	 **/
+	T load() const{
+		for(;;){
+			std::uint64_t begin = m_sequence.load(std::memory_order_acquire);
+			if((begin & 1) == 0){
+				T value = loadWords();
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if(m_sequence.load(std::memory_order_relaxed) == begin){
+					return value;
+				}
+			}
+			std::this_thread::yield();
+		}
+	}
+	void store(const T& value){
+		std::uint64_t sequence = lockWriters();
+		storeWords(value);
+		m_sequence.store(sequence + 2, std::memory_order_release);
+	}
+	template<class Callable>
+	/**
+	 * Modifies value in place while other writers are excluded.
+	 * 
+	 * @param callable functor with signature void(T& value).
+	 **/
+	void update(Callable&& callable){
+		std::uint64_t sequence = lockWriters();
+		T value = loadWords();
+		callable(value);
+		storeWords(value);
+		m_sequence.store(sequence + 2, std::memory_order_release);
+	}
+
+private: // static members
+	static constexpr std::size_t word_count = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+private: // functions
+	/**
+	 * Makes sequence odd, waiting for other writer to finish.
+	 * 
+	 * @return even sequence before writing.
+	 **/
+	std::uint64_t lockWriters(){
+		std::uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+		for(;;){
+			if((sequence & 1) == 0 && m_sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed)){
+				std::atomic_thread_fence(std::memory_order_release);
+				return sequence;
+			}
+			std::this_thread::yield();
+			sequence = m_sequence.load(std::memory_order_relaxed);
+		}
+	}
+	// value is copied through atomic words, so racing reads are well defined and only discarded
+	T loadWords() const{
+		std::uint64_t words[word_count];
+		for(std::size_t i = 0; i < word_count; ++i){
+			words[i] = m_words[i].load(std::memory_order_relaxed);
+		}
+		T value;
+		std::memcpy(&value, words, sizeof(T));
+		return value;
+	}
+	void storeWords(const T& value){
+		std::uint64_t words[word_count] = {};
+		std::memcpy(words, &value, sizeof(T));
+		for(std::size_t i = 0; i < word_count; ++i){
+			m_words[i].store(words[i], std::memory_order_relaxed);
+		}
+	}
+
+private: // members
+	std::atomic<std::uint64_t> m_sequence{0};
+	std::array<std::atomic<std::uint64_t>, word_count> m_words;
+};
+
+template<class T, class Mutex = std::shared_mutex>
+/**
+ * Value guarded by its own reader/writer lock, for types which are not trivially copyable.
+ **/
+class RwLocked{
+public: // type definitions
+	using value_type = T;
+
+public: // functions
+	RwLocked() = default;
+	explicit RwLocked(T value) : m_value(std::move(value)){}
+	RwLocked(const RwLocked&) = delete;
+	RwLocked& operator=(const RwLocked&) = delete;
+
+	T load() const{
+		std::shared_lock<Mutex> lock(m_mutex);
+		return m_value;
+	}
+	void store(T value){
+		std::unique_lock<Mutex> lock(m_mutex);
+		m_value = std::move(value);
+	}
+	template<class Callable>
+	/**
+	 * @param callable functor with signature void(T& value), called under exclusive lock.
+	 **/
+	void update(Callable&& callable){
+		std::unique_lock<Mutex> lock(m_mutex);
+		callable(m_value);
+	}
+
+private: // members
+	mutable Mutex m_mutex;
+	T m_value{};
+};
+
+template<class T, class Mutex = std::shared_mutex>
+/**
+ * Refference to member guarded by reader/writer lock shared by whole object,
+ *  constructed on demand e.g. when presenting properties.
+ **/
+class Guarded{
+public: // type definitions
+	using value_type = T;
+
+public: // functions
+	Guarded(Mutex& mutex, T& value) : m_mutex(mutex), m_value(value){}
+
+	T load() const{
+		std::shared_lock<Mutex> lock(m_mutex);
+		return m_value;
+	}
+	void store(T value){
+		std::unique_lock<Mutex> lock(m_mutex);
+		m_value = std::move(value);
+	}
+	template<class Callable>
+	void update(Callable&& callable){
+		std::unique_lock<Mutex> lock(m_mutex);
+		callable(m_value);
+	}
+
+private: // members
+	Mutex& m_mutex;
+	T& m_value;
+};
+
+/**
+ * Sequence lock for small trivially copyable types, reader/writer lock otherwise.
+ **/
+template<class T>
+using Synchronized = std::conditional_t<std::is_trivially_copyable_v<T> && sizeof(T) <= 64, SeqLocked<T>, RwLocked<T>>;
+
+template<class Source>
+/**
+ * Snapshot of synchronized value taken by read of its property, so visitor reads consistent value
+ *  even while other threads write it. Write stores new value back into source.
+ * View is meant to be local to single visit (e.g. in function presenting properties), so each visiting thread has its own snapshot.
+ * 
+ * Usage:
+ *   nap::SyncView position(m_position); // nap::Synchronized<Vec3> m_position;
+ *   Property::Visitor::visit(visitor, {
+ *       position.property<Property>("position"),
+ *       ...
+ *   });
+ **/
+class SyncView{
+public: // type definitions
+	using value_type = typename Source::value_type;
+
+public: // functions
+	explicit SyncView(Source& source) : m_source(source){}
+	SyncView(const SyncView&) = delete;
+	SyncView& operator=(const SyncView&) = delete;
+
+	template<class PropertyT>
+	/**
+	 * @return property reading snapshot of source and writing into source, which refferences this view.
+	 **/
+	PropertyT property(typename PropertyT::string_type name){
+		using storage_policy = typename PropertyT::storage_policy;
+		using Signature = void(typename PropertyT::any_type&);
+		return PropertyT(name,
+			storage_policy::template bind<Signature, &Read<PropertyT>>(*this),
+			storage_policy::template bind<Signature, &Write<PropertyT>>(*this)
+		);
+	}
+
+	/**
+	 * @return last snapshot read by property.
+	 **/
+	const value_type& snapshot() const{return m_snapshot;}
+
+public: // static functions
+	// invokers bound by property(name)
+	template<class PropertyT>
+	static void Read(SyncView& view, typename PropertyT::any_type& entry){
+		view.m_snapshot = view.m_source.load();
+		entry = PropertyT::interface::template read<value_type>(std::as_const(view.m_snapshot));
+	}
+	template<class PropertyT>
+	static void Write(SyncView& view, typename PropertyT::any_type& entry){
+		value_type value = view.m_snapshot;
+		PropertyT::interface::template write<value_type>(value, entry);
+		view.m_source.store(std::move(value));
+	}
+
+private: // members
+	Source& m_source;
+	value_type m_snapshot{};
+};
+}
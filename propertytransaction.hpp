@@ -0,0 +1,301 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+#pragma once
+#include "property.hpp"
+#include "propertyarena.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace nap{
+
+namespace detail{
+
+/**
+ * Copy, assignment and destruction of type which is not trivially copyable, used to save and restore its values.
+ **/
+struct ValueLifetime{
+	void (*copy)(void* destination, const void* source); // copy constructs into uninitialized storage
+	void (*assign)(void* destination, const void* source);
+	void (*destroy)(void* value);
+};
+
+template<typename T>
+inline constexpr ValueLifetime value_lifetime_of{
+	[](void* destination, const void* source){::new(destination) T(*static_cast<const T*>(source));},
+	[](void* destination, const void* source){*static_cast<T*>(destination) = *static_cast<const T*>(source);},
+	[](void* value){static_cast<T*>(value)->~T();}
+};
+
+template<typename... Types>
+/**
+ * Table of types which are not trivially copyable and which values PropertyTransaction can save, matched by type metadata.
+ * Copy and assignment are instantiated only for listed types.
+ **/
+struct TransactionTypeTable{
+	/**
+	 * @return lifetime operations of type, or nullptr when it is not listed.
+	 **/
+	static const ValueLifetime* Find(const TypeInfo* type){
+		const ValueLifetime* lifetime = nullptr;
+		((type == TypeInfoOf<Types>() && (lifetime = &value_lifetime_of<Types>)) || ...);
+		return lifetime;
+	}
+};
+
+using DefaultTransactionTypes = TransactionTypeTable<std::string>;
+}
+
+template<class PropertyT, class TypeTable = detail::DefaultTransactionTypes>
+/**
+ * Transaction over properties of object, begin then write properties through it and either commit or rollback.
+ * Only properties which were actually written are recorded, each once with value it had before first write,
+ *  trivially copyable values are copied into one compact byte buffer, other values are copy constructed into arena,
+ *  so rollback of failed update costs proportionally to what was changed, not to size of whole object.
+ * Only writable variable properties with type metadata (constructed from member refference) can be written,
+ *  since their previous value can be restored without the property itself.
+ * Values which are not trivially copyable need their type listed in TypeTable, or passed to write<T>/record<T>.
+ * Recorded variables have to outlive transaction until commit or rollback.
+ * 
+ * Usage:
+ *   nap::PropertyTransaction<Property> transaction;
+ *   transaction.begin();
+ *   object.propertiesFunc(Property::Visitor([&](const Property& property){
+ *       Property::any_type value = ...;
+ *       transaction.write(property, value);
+ *       return true;
+ *   }));
+ *   if(nap::Validate(object)) transaction.commit(); else transaction.rollback();
+ **/
+class PropertyTransaction{
+public: // type definitions
+	using any_type = typename PropertyT::any_type;
+
+public: // functions
+	PropertyTransaction() = default;
+	PropertyTransaction(const PropertyTransaction&) = delete;
+	PropertyTransaction& operator=(const PropertyTransaction&) = delete;
+
+	/**
+	 * Releases recorded values without restoring them, same as commit.
+	 **/
+	~PropertyTransaction(){
+		clear();
+	}
+
+	/**
+	 * Starts transaction, values recorded by previous one which was not finished are released without restoring them.
+	 **/
+	void begin(){
+		clear();
+		m_active = true;
+	}
+	/**
+	 * Records current value of property when it was not yet recorded in this transaction, then writes new value.
+	 * Value is still recorded when write fails (e.g. throws), so rollback restores it as well.
+	 * 
+	 * @param property writable variable property, with type metadata.
+	 * @param value new value passed to property write.
+	 * 
+	 * @return true when value was recorded and written, or false without writing when transaction is not active or previous value cannot be recorded.
+	 **/
+	bool write(const PropertyT& property, any_type& value){
+		if(!record(property)){
+			return false;
+		}
+		property.write(value);
+		return true;
+	}
+	template<typename T>
+	/**
+	 * Same as write, for property of type T which does not have to be listed in TypeTable.
+	 * 
+	 * @return false without writing when property is not of type T, otherwise same as write.
+	 **/
+	bool write(const PropertyT& property, any_type& value){
+		if(!record<T>(property)){
+			return false;
+		}
+		property.write(value);
+		return true;
+	}
+	/**
+	 * Records current value of property without writing it, e.g. before it is modified directly through its variable.
+	 * 
+	 * @return true when value is recorded (now or previously), otherwise false.
+	 **/
+	bool record(const PropertyT& property){
+		const TypeInfo* type = property.type();
+		return (type != nullptr) && recordValue(property, type->triviallyCopyable ? nullptr : TypeTable::Find(type));
+	}
+	template<typename T>
+	/**
+	 * Same as record, for property of type T which does not have to be listed in TypeTable.
+	 **/
+	bool record(const PropertyT& property){
+		if(!property.template isType<T>()){
+			return false;
+		}
+		if constexpr(std::is_trivially_copyable_v<T>){
+			return recordValue(property, nullptr);
+		}
+		else{
+			return recordValue(property, &detail::value_lifetime_of<std::remove_cv_t<T>>);
+		}
+	}
+	/**
+	 * Keeps written values and finishes transaction.
+	 **/
+	void commit(){
+		clear();
+	}
+	/**
+	 * Restores recorded values in reverse order of recording and finishes transaction.
+	 **/
+	void rollback(){
+		for(auto entry = m_entries.rbegin(); entry != m_entries.rend(); ++entry){
+			if(entry->saved == nullptr){
+				std::memcpy(entry->address, m_bytes.data() + entry->offset, entry->type->size);
+			}
+			else{
+				entry->lifetime->assign(entry->address, entry->saved);
+			}
+		}
+		clear();
+	}
+
+	/**
+	 * @return true between begin and commit or rollback.
+	 **/
+	bool isActive() const{return m_active;}
+	/**
+	 * @return count of properties recorded in current transaction.
+	 **/
+	std::size_t size() const{return m_entries.size();}
+	/**
+	 * @return bytes used by trivially copyable values recorded in current transaction.
+	 **/
+	std::size_t bytes() const{return m_bytes.size();}
+
+private: // type definitions
+	struct Entry{
+		void* address;
+		const TypeInfo* type;
+		std::size_t offset; // within byte buffer, for trivially copyable values
+		const detail::ValueLifetime* lifetime;
+		void* saved; // copy in arena, for other values
+	};
+
+private: // static members
+	static constexpr std::size_t MinimalIndexSize = 16;
+
+private: // static functions
+	/**
+	 * @return slot of address in open addressing index (size of power of two), or empty slot where it belongs.
+	 **/
+	static std::size_t IndexSlot(const std::vector<const void*>& index, const void* address){
+		const std::size_t mask = index.size() - 1;
+		std::size_t slot = static_cast<std::size_t>((reinterpret_cast<std::uintptr_t>(address) * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+		while(index[slot] != nullptr && index[slot] != address){
+			slot = (slot + 1) & mask;
+		}
+		return slot;
+	}
+
+private: // functions
+	/**
+	 * @param lifetime operations of value type, nullptr for trivially copyable values.
+	 **/
+	bool recordValue(const PropertyT& property, const detail::ValueLifetime* lifetime){
+		const TypeInfo* type = property.type();
+		if(!m_active || !property.isWritable() || !property.isVariable() || type == nullptr){
+			return false;
+		}
+		const void* address = property.address();
+		const void*& indexed = m_index.empty() ? reserveIndex(address) : m_index[IndexSlot(m_index, address)];
+		if(indexed == address){
+			return true;
+		}
+		if(type->triviallyCopyable){
+			const std::size_t offset = m_bytes.size();
+			m_bytes.resize(offset + type->size);
+			std::memcpy(m_bytes.data() + offset, address, type->size);
+			m_entries.push_back({const_cast<void*>(address), type, offset, nullptr, nullptr});
+		}
+		else if(lifetime != nullptr){
+			void* saved = m_arena.resource()->allocate(type->size, type->alignment);
+			lifetime->copy(saved, address);
+			m_entries.push_back({const_cast<void*>(address), type, 0, lifetime, saved});
+		}
+		else{
+			return false;
+		}
+		indexed = address;
+		if(m_entries.size() * 2 >= m_index.size()){
+			growIndex();
+		}
+		return true;
+	}
+	/**
+	 * Allocates initial index, so first lookup has slot to fill.
+	 **/
+	const void*& reserveIndex(const void* address){
+		m_index.assign(MinimalIndexSize, nullptr);
+		return m_index[IndexSlot(m_index, address)];
+	}
+	/**
+	 * Doubles index and inserts recorded addresses again, in order of recording.
+	 **/
+	void growIndex(){
+		m_index.assign(m_index.size() * 2, nullptr);
+		for(const Entry& entry : m_entries){
+			m_index[IndexSlot(m_index, entry.address)] = entry.address;
+		}
+	}
+	void clear(){
+		// removed in reverse order of recording, so probing for each address still passes addresses recorded before it
+		for(auto entry = m_entries.rbegin(); entry != m_entries.rend(); ++entry){
+			m_index[IndexSlot(m_index, entry->address)] = nullptr;
+			if(entry->saved != nullptr){
+				entry->lifetime->destroy(entry->saved);
+			}
+		}
+		m_entries.clear();
+		m_bytes.clear();
+		m_arena.release();
+		m_active = false;
+	}
+
+private: // members
+	std::vector<Entry> m_entries;
+	std::vector<const void*> m_index; // addresses of recorded entries, at most half full
+	std::vector<unsigned char> m_bytes;
+	VisitArena m_arena{1024};
+	bool m_active = false;
+};
+
+}
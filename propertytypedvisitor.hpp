@@ -0,0 +1,180 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#pragma once
+#include "property.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace nap{
+
+template<class... Handlers>
+/**
+ * Helper for building overload set out of lambdas, e.g. handler for TypedVisitor.
+ **/
+struct Overloaded : Handlers...{
+	using Handlers::operator()...;
+};
+template<class... Handlers>
+Overloaded(Handlers...) -> Overloaded<Handlers...>;
+
+template<class PropertyT, class Handler, typename... Types>
+/**
+ * Visitor dispatching each property to handler overload of its type, via static tables shared by all instances.
+ * Each of Types has dense id (its position in Types), interface type key of read value is mapped to that id
+ *  through small open addressing table and id indexes dispatch table, so cost does not grow with count of Types.
+ * 
+ * Handler is called as:
+ *   * handler(property, const T& value)           - for each of Types read from property.
+ *   * handler(property, any_type& value)          - optional, for readable properties of other types.
+ *   * handler(property)                           - optional, for name only and nested properties (which can descend via visitChildren).
+ * When optional overload is missing, property is skipped and visiting continues.
+ * 
+ * Interface has to provide type_key, key_of<T>(), key_of(const any_type&) and hash_key(const type_key&),
+ *  where key_of<T>() matches any for which is_any<T> is true.
+ **/
+class TypedVisitor{
+public: // type definitions
+	using any_type  = typename PropertyT::any_type;
+	using interface = typename PropertyT::interface;
+	using type_key  = typename interface::type_key;
+
+public: // functions
+	TypedVisitor(const Handler& handler) : m_handler(handler){}
+
+	/**
+	 * Reads property and passes its value to handler overload of its type.
+	 * 
+	 * @param property property to be visited.
+	 * 
+	 * @return return value of handler, or true when property was skipped.
+	 **/
+	bool operator()(const PropertyT& property) const{
+		if(property.isNameOnly() || property.isNested()){
+			if constexpr(std::is_invocable_v<const Handler&, const PropertyT&>){
+				return m_handler(property);
+			}
+			return true;
+		}
+		if(!property.isReadable()){
+			return true;
+		}
+
+		any_type value;
+		property.read(value);
+
+		const std::size_t id = IdOf(interface::key_of(value));
+		if(id != NoId){
+			return Dispatchers[id](m_handler, property, value);
+		}
+		if constexpr(std::is_invocable_v<const Handler&, const PropertyT&, any_type&>){
+			return m_handler(property, value);
+		}
+		return true;
+	}
+	/**
+	 * Executes visitor over single property.
+	 * 
+	 * @see operator()
+	 **/
+	bool visit(const PropertyT& property) const{
+		return (*this)(property);
+	}
+
+private: // type definitions
+	using DispatchFunc = bool(*)(const Handler&, const PropertyT&, any_type&);
+
+	static constexpr std::size_t NoId = sizeof...(Types);
+	// at most quarter of slots is used, so lookup mostly ends at first slot
+	static constexpr std::size_t SlotBits = [](){
+		std::size_t bits = 1;
+		while((std::size_t(1) << bits) < 4 * sizeof...(Types)){
+			++bits;
+		}
+		return bits;
+	}();
+	static constexpr std::size_t SlotMask = (std::size_t(1) << SlotBits) - 1;
+
+	struct KeyTable{
+		std::array<type_key, sizeof...(Types)> keys; // indexed by id
+		std::array<std::size_t, SlotMask + 1> ids;   // id of type, NoId for empty slot
+	};
+
+private: // static functions
+	template<typename T>
+	static bool Dispatch(const Handler& handler, const PropertyT& property, any_type& value){
+		return handler(property, interface::template cast_any<T>(value));
+	}
+
+	static std::size_t SlotOf(const type_key& key){
+		const std::uint64_t hash = static_cast<std::uint64_t>(interface::hash_key(key)) * 0x9E3779B97F4A7C15ull;
+		return static_cast<std::size_t>(hash >> (64 - SlotBits));
+	}
+	/**
+	 * @return id of type with given key, or NoId when it is not one of Types.
+	 **/
+	static std::size_t IdOf(const type_key& key){
+		// built on first use, so visitor can be used during static initialization as well
+		static const KeyTable table = MakeKeyTable();
+		for(std::size_t slot = SlotOf(key); table.ids[slot] != NoId; slot = (slot + 1) & SlotMask){
+			if(table.keys[table.ids[slot]] == key){
+				return table.ids[slot];
+			}
+		}
+		return NoId;
+	}
+	static KeyTable MakeKeyTable(){
+		KeyTable table{{interface::template key_of<Types>()...}, {}};
+		table.ids.fill(NoId);
+		for(std::size_t id = 0; id < table.keys.size(); ++id){
+			std::size_t slot = SlotOf(table.keys[id]);
+			while(table.ids[slot] != NoId && !(table.keys[table.ids[slot]] == table.keys[id])){
+				slot = (slot + 1) & SlotMask;
+			}
+			// type listed twice keeps its first id
+			if(table.ids[slot] == NoId){
+				table.ids[slot] = id;
+			}
+		}
+		return table;
+	}
+
+private: // static members
+	static constexpr std::array<DispatchFunc, sizeof...(Types)> Dispatchers{&Dispatch<Types>...};
+
+private: // members
+	const Handler m_handler;
+};
+
+template<class PropertyT, typename... Types, class Handler>
+/**
+ * Makes TypedVisitor for given property template and types, deducing handler type.
+ * 
+ * @param handler functor or Overloaded set of functors, one for each of Types.
+ **/
+TypedVisitor<PropertyT, Handler, Types...> MakeTypedVisitor(const Handler& handler){
+	return TypedVisitor<PropertyT, Handler, Types...>(handler);
+}
+}
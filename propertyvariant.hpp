@@ -0,0 +1,174 @@
+/******************************  <MIT License>  ******************************
+ * Copyright (c) 2021 QIZI94
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *****************************************************************************/
+
+#pragma once
+#include "property.hpp"
+
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+namespace nap{
+
+namespace detail{
+
+template<typename T, typename Variant>
+struct variant_index;
+
+template<typename T, typename... Alternatives>
+/**
+ * Index of T within std::variant alternatives, or std::variant_npos when T is not one of them.
+ **/
+struct variant_index<T, std::variant<Alternatives...>>{
+	static constexpr std::size_t value = [](){
+		constexpr bool matches[] = {std::is_same_v<T, Alternatives>...};
+		for(std::size_t i = 0; i < sizeof...(Alternatives); ++i){
+			if(matches[i]){
+				return i;
+			}
+		}
+		return std::variant_npos;
+	}();
+};
+
+template<typename... Types>
+/**
+ * Implementation of interface for closed set of types, which uses C++17 std::variant
+ *  of pointers to Types (and const Types) instead of std::any.
+ * Type checks are index comparisons, so it does not need RTTI and can be built with -fno-rtti.
+ * 
+ * Follows the same rules as DefaultInterface, values are kept as pointers to passed variables.
+ **/
+struct VariantInterface{
+	using any_type          = std::variant<std::monostate, Types*..., const Types*...>;
+	using string_type       = std::string_view;
+	using string_type_ref   = std::string_view;
+	template<typename T>
+	using internal_type 	= typename std::remove_pointer<typename std::remove_reference<T>::type>::type*;
+
+	template<typename T>
+	static any_type make_any(T& value){
+		return make_any_impl(value);
+	}
+
+	template<typename T>
+	static any_type make_any(const T& value){
+		return make_any_impl(value);
+	}
+
+	template<typename T>
+	static const std::remove_reference_t<T>& cast_any(const any_type& any){
+		return *get_any<internal_type<const T>>(any);
+	}
+	template<typename T>
+	static std::conditional_t<std::is_reference_v<T>, std::remove_reference_t<T>&, const T&> cast_any(any_type& any){
+		if constexpr (std::is_reference_v<T>){
+			return *get_any<internal_type<T>>(any);
+		}
+		else{
+			return *get_any<internal_type<const T>>(any);
+		}
+	}
+	template<typename T>
+	static bool is_any(const any_type& any){
+		return (any.index() == key_of<T>());
+	}
+	/**
+	 * Stable key of type stored in any_type, which is index of the variant alternative.
+	 * key_of<T>() is std::variant_npos for types which are not part of Types.
+	 **/
+	using type_key = std::size_t;
+
+	template<typename T>
+	static constexpr type_key key_of(){
+		if constexpr(std::is_reference_v<T>){
+			return variant_index<internal_type<T>, any_type>::value;
+		}
+		else{
+			return variant_index<internal_type<const T>, any_type>::value;
+		}
+	}
+	static type_key key_of(const any_type& any){
+		return any.index();
+	}
+	static std::size_t hash_key(const type_key& key){
+		return key;
+	}
+	template<typename T>
+	static auto read(T& value){
+		return make_any<const T&>(value);
+	}
+	template<typename T>
+	static auto read(const T& value){
+		return make_any<T>(value);
+	}
+	template<typename T>
+	static void write(T& value, any_type& any){
+		static_assert(variant_index<internal_type<T>, any_type>::value != std::variant_npos, "type is not part of VariantInterface Types");
+		if(internal_type<T>* movable = std::get_if<internal_type<T>>(&any)){
+			value = std::move(**movable);
+			return;
+		}
+		// write by copy
+		value = cast_any<const T&>(any);
+	}
+
+	private:
+
+	template<typename Pointer>
+	/**
+	 * Same as std::get, with readable error when type is not part of Types.
+	 **/
+	static Pointer get_any(const any_type& any){
+		static_assert(variant_index<Pointer, any_type>::value != std::variant_npos, "type is not part of VariantInterface Types");
+		return std::get<Pointer>(any);
+	}
+	template<typename Pointer, typename T>
+	static any_type make_any_pointer(T* value){
+		static_assert(variant_index<Pointer, any_type>::value != std::variant_npos, "type is not part of VariantInterface Types");
+		return any_type(std::in_place_type<Pointer>, value);
+	}
+	template<typename T>
+	static any_type make_any_impl(const T& value){
+		return make_any_pointer<internal_type<const T>>(&value);
+	}
+	template<typename T>
+	static any_type make_any_impl(T& value){
+		return make_any_pointer<internal_type<T>>(&value);
+	}
+};
+
+template<typename T, typename... Types>
+/**
+ * VariantInterface holds only values of its Types.
+ **/
+struct interface_supports<VariantInterface<Types...>, T> : std::bool_constant<(std::is_same_v<T, Types> || ...)>{};
+
+}
+
+template<typename... Types>
+/**
+ * Property template with variant implementation of the interface, limited to closed set of Types.
+ **/
+using VariantProperty = PropertyTemplate<detail::VariantInterface<Types...>>;
+}